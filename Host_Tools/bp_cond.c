@@ -0,0 +1,126 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    bp_cond.c
+ * @brief   Sets a conditional breakpoint on the monitor.
+ * @details Compiles the condition to bytecode, adds the breakpoint with the
+ *          monitor's 'B' 'A' command if it is not in the table yet, and
+ *          uploads the program with 'B' 'I'. The INT1 handler then decides
+ *          on the target whether a pass over the breakpoint stops.
+ *
+ *          Usage: bp_cond [-i baud] <port> <address> "<condition>"
+ *                 bp_cond -c "<condition>"
+ *
+ *          -c only compiles and prints the bytecode. An empty condition
+ *          turns the breakpoint back into an unconditional one.
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "cond.h"
+#include "serial.h"
+
+#define PROMPT_TIMEOUT_MS (2000)
+#define QUIET_MS (300)
+
+
+static void usage(void);
+static int upload(int fd, unsigned long address, const uint8_t *program, size_t length);
+
+
+static void usage(void) {
+    fprintf(stderr, "usage: bp_cond [-i baud] <port> <address> \"<condition>\"\n"
+                    "       bp_cond -c \"<condition>\"\n");
+    exit(2);
+}
+
+static int upload(int fd, unsigned long address, const uint8_t *program, size_t length) {
+    char command[8];
+    uint8_t packet[COND_MAX + 2];
+    uint8_t sum = (uint8_t)length;
+
+    snprintf(command, sizeof(command), "BA%04lX", address);
+    if (serial_write(fd, command, 6) < 0 || serial_expect(fd, "Command: ", PROMPT_TIMEOUT_MS) < 0) {
+        fprintf(stderr, "bp_cond: monitor did not accept the breakpoint\n");
+        return -1;
+    }
+
+    command[1] = 'I';
+    if (serial_write(fd, command, 6) < 0 || serial_expect(fd, "Condition: ", PROMPT_TIMEOUT_MS) < 0) {
+        fprintf(stderr, "bp_cond: breakpoint table is full\n");
+        return -1;
+    }
+
+    packet[0] = (uint8_t)length;
+    memcpy(packet + 1, program, length);
+    for (size_t i = 0; i < length; i++)
+        sum += program[i];
+    packet[length + 1] = (uint8_t)-sum;
+    if (serial_write(fd, packet, length + 2) < 0 ||
+        serial_expect(fd, "Condition set", PROMPT_TIMEOUT_MS) < 0) {
+        fprintf(stderr, "bp_cond: monitor rejected the condition\n");
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    long initial_baud = SERIAL_DEFAULT_BAUD;
+    int compile_only = 0;
+    uint8_t program[COND_MAX];
+    size_t length;
+    char error[80];
+    unsigned long address = 0;
+    char *end;
+    int opt, fd;
+
+    while ((opt = getopt(argc, argv, "i:c")) != -1) {
+        if (opt == 'i')
+            initial_baud = strtol(optarg, NULL, 10);
+        else if (opt == 'c')
+            compile_only = 1;
+        else
+            usage();
+    }
+    if (argc - optind != (compile_only ? 1 : 3))
+        usage();
+
+    if (cond_compile(argv[argc - 1], program, &length, error, sizeof(error)) < 0) {
+        fprintf(stderr, "bp_cond: %s\n", error);
+        return 2;
+    }
+    if (compile_only) {
+        printf("%zu bytes\n", length);
+        cond_disassemble(program, length);
+        return 0;
+    }
+
+    address = strtoul(argv[optind + 1], &end, 16);
+    if (*end != '\0' || address > 0xFFFF) {
+        fprintf(stderr, "bp_cond: invalid address\n");
+        return 2;
+    }
+    fd = serial_open(argv[optind], initial_baud);
+    if (fd < 0)
+        return 1;
+    serial_drain(fd, QUIET_MS);
+    if (upload(fd, address, program, length) < 0)
+        return 1;
+    printf("breakpoint %04lX: %s\n", address, length ? argv[argc - 1] : "unconditional");
+    close(fd);
+    return 0;
+}
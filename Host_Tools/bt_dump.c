@@ -0,0 +1,164 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    bt_dump.c
+ * @brief   Host client for the memory editor's binary dump command.
+ * @details Sends the 'B' command with a raw range request, reassembles the
+ *          CRC-checked frames into a binary file and re-requests the rest
+ *          of the range if a frame is lost or corrupted.
+ *
+ *          Usage: bt_dump [-i baud] [-b baud] <port> <C|X> <start> <end> <outfile>
+ *
+ *          -i is the rate the target runs at now (default 9600); -b
+ *          renegotiates the link to a faster rate before the transfer.
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "frame.h"
+#include "serial.h"
+
+#define MAX_RETRIES (3)
+#define QUIET_MS (500)
+
+
+static void usage(void);
+static int parse_address(const char *text, unsigned long *address);
+static int send_request(int fd, char space, unsigned long start, unsigned long end);
+
+
+static void usage(void) {
+    fprintf(stderr, "usage: bt_dump [-i baud] [-b baud] <port> <C|X> <start> <end> <outfile>\n");
+    exit(2);
+}
+
+static int parse_address(const char *text, unsigned long *address) {
+    char *end;
+
+    *address = strtoul(text, &end, 16);
+    return (*end == '\0' && *address <= 0xFFFF) ? 0 : -1;
+}
+
+static int send_request(int fd, char space, unsigned long start, unsigned long end) {
+    uint8_t request[6] = {
+        'B', (uint8_t)space,
+        (uint8_t)(start >> 8), (uint8_t)start,
+        (uint8_t)(end >> 8), (uint8_t)end
+    };
+
+    return serial_write(fd, request, sizeof(request));
+}
+
+int main(int argc, char **argv) {
+    long initial_baud = SERIAL_DEFAULT_BAUD;
+    long baud = 0;
+    unsigned long start, end, next;
+    char space;
+    int opt, fd, retries = 0;
+    uint8_t *image;
+    FILE *out;
+
+    while ((opt = getopt(argc, argv, "i:b:")) != -1) {
+        if (opt == 'i')
+            initial_baud = strtol(optarg, NULL, 10);
+        else if (opt == 'b')
+            baud = strtol(optarg, NULL, 10);
+        else
+            usage();
+    }
+    if (argc - optind != 5)
+        usage();
+
+    space = (char)(argv[optind + 1][0] & ~0x20);
+    if ((space != 'C' && space != 'X') ||
+        parse_address(argv[optind + 2], &start) < 0 ||
+        parse_address(argv[optind + 3], &end) < 0 || end < start) {
+        fprintf(stderr, "bt_dump: invalid space or range\n");
+        return 2;
+    }
+    if (space == 'X' && end > 0x7FFF) {
+        fprintf(stderr, "bt_dump: XRAM ends at 7FFF\n");
+        return 2;
+    }
+
+    fd = serial_open(argv[optind], initial_baud);
+    if (fd < 0)
+        return 1;
+    if (baud && serial_negotiate_baud(fd, initial_baud, baud) < 0)
+        return 1;
+    image = malloc(end - start + 1);
+    if (!image) {
+        perror("bt_dump");
+        return 1;
+    }
+
+    next = start;
+    while (next <= end) {
+        frame_t frame;
+        frame_status_t status = FRAME_OK;
+        uint8_t expected = 0;
+
+        if (send_request(fd, space, next, end) < 0)
+            return 1;
+
+        for (;;) {
+            status = frame_receive(fd, &frame);
+            if (status != FRAME_OK)
+                break;
+            if (frame.seq != expected) {
+                fprintf(stderr, "bt_dump: expected frame %u, got %u\n", expected, frame.seq);
+                status = FRAME_BAD_LENGTH;
+                break;
+            }
+            if (frame.len == 0)
+                break;
+            if (next + frame.len > end + 1) {
+                status = FRAME_BAD_LENGTH;
+                break;
+            }
+            memcpy(image + (next - start), frame.payload, frame.len);
+            next += frame.len;
+            expected++;
+            fprintf(stderr, "\r%04lX / %04lX", next - 1, end);
+        }
+        fprintf(stderr, "\n");
+
+        // Let the editor finish its reply and return to the prompt
+        serial_drain(fd, QUIET_MS);
+
+        if (status == FRAME_OK && next <= end) {
+            fprintf(stderr, "bt_dump: target ended the stream early at %04lX\n", next);
+            return 1;
+        }
+        if (status != FRAME_OK) {
+            fprintf(stderr, "bt_dump: %s at %04lX\n", frame_status_name(status), next);
+            if (++retries > MAX_RETRIES)
+                return 1;
+        }
+    }
+
+    out = fopen(argv[optind + 4], "wb");
+    if (!out || fwrite(image, 1, end - start + 1, out) != end - start + 1) {
+        perror(argv[optind + 4]);
+        return 1;
+    }
+    fclose(out);
+    close(fd);
+    free(image);
+    printf("%lu bytes written to %s\n", end - start + 1, argv[optind + 4]);
+    return 0;
+}
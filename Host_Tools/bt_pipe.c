@@ -0,0 +1,412 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    bt_pipe.c
+ * @brief   Pipelined multi-range client for the memory editor ('Q' command).
+ * @details Splits every job into requests and keeps up to a window of them
+ *          outstanding, so the Bluetooth link latency is paid once per run
+ *          instead of once per request. Replies arrive in request order;
+ *          after a lost or corrupted reply everything from the first
+ *          unanswered request is sent again (go-back-N).
+ *
+ *          Usage: bt_pipe [-i baud] [-b baud] [-w window] [-c chunk] <port> <job>...
+ *
+ *          Jobs:  read <C|X> <start> <end> <outfile>
+ *                 write <start> <infile>         (XRAM)
+ *                 crc <C|X> <start> <end>
+ *
+ *          -w limits the window (default: what the target announces,
+ *          -w 1 is stop-and-wait), -c is the bytes per read request
+ *          (default 256). -i and -b work as in bt_dump.
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "request.h"
+#include "serial.h"
+
+#define DEFAULT_CHUNK (256)
+#define MAX_WINDOW (64)
+#define MAX_RETRIES (3)
+#define QUIET_MS (500)
+#define XRAM_END (0x7FFF)
+#define RANGE_PAYLOAD_LENGTH (5)
+// Enough filler to complete any request the target is still reading
+#define FLUSH_BYTES (6 + REQUEST_PAYLOAD_MAX)
+
+typedef struct {
+    char kind;
+    char space;
+    unsigned long start, end;
+    const char *path;
+    uint8_t *data;
+} job_t;
+
+typedef struct {
+    uint8_t op;
+    uint8_t len;
+    uint8_t payload[REQUEST_PAYLOAD_MAX];
+    job_t *job;
+    unsigned long offset;
+    unsigned long size;
+} pipe_request_t;
+
+
+static void usage(void);
+static int parse_address(const char *text, unsigned long *address);
+static int parse_space(const char *text, char *space);
+static int parse_jobs(int argc, char **argv, job_t *jobs);
+static unsigned long count_requests(const job_t *jobs, int job_count, unsigned long chunk);
+static void build_requests(job_t *jobs, int job_count, unsigned long chunk, pipe_request_t *requests);
+static int send_one(int fd, const pipe_request_t *requests, unsigned long index);
+static int receive_one(int fd, const pipe_request_t *request, uint8_t seq);
+static int finish_jobs(const job_t *jobs, int job_count);
+static double now_seconds(void);
+
+
+static void usage(void) {
+    fprintf(stderr, "usage: bt_pipe [-i baud] [-b baud] [-w window] [-c chunk] <port> <job>...\n"
+                    "jobs:  read <C|X> <start> <end> <outfile>\n"
+                    "       write <start> <infile>\n"
+                    "       crc <C|X> <start> <end>\n");
+    exit(2);
+}
+
+static int parse_address(const char *text, unsigned long *address) {
+    char *end;
+
+    *address = strtoul(text, &end, 16);
+    return (*end == '\0' && *address <= 0xFFFF) ? 0 : -1;
+}
+
+static int parse_space(const char *text, char *space) {
+    *space = (char)(text[0] & ~0x20);
+    return ((*space == 'C' || *space == 'X') && text[1] == '\0') ? 0 : -1;
+}
+
+/*
+ * Fills jobs[] from the command line and returns how many there are; write
+ * jobs load their file here so a bad path stops the run before it starts.
+ */
+static int parse_jobs(int argc, char **argv, job_t *jobs) {
+    int count = 0;
+    int i = 0;
+
+    while (i < argc) {
+        job_t *job = &jobs[count];
+
+        memset(job, 0, sizeof(*job));
+        if (strcmp(argv[i], "read") == 0 && argc - i >= 5) {
+            job->kind = REQUEST_READ;
+            job->path = argv[i + 4];
+            if (parse_space(argv[i + 1], &job->space) < 0 ||
+                parse_address(argv[i + 2], &job->start) < 0 ||
+                parse_address(argv[i + 3], &job->end) < 0)
+                return -1;
+            i += 5;
+        } else if (strcmp(argv[i], "crc") == 0 && argc - i >= 4) {
+            job->kind = REQUEST_CRC;
+            if (parse_space(argv[i + 1], &job->space) < 0 ||
+                parse_address(argv[i + 2], &job->start) < 0 ||
+                parse_address(argv[i + 3], &job->end) < 0)
+                return -1;
+            i += 4;
+        } else if (strcmp(argv[i], "write") == 0 && argc - i >= 3) {
+            FILE *in;
+            long size;
+
+            job->kind = REQUEST_WRITE;
+            job->space = 'X';
+            job->path = argv[i + 2];
+            if (parse_address(argv[i + 1], &job->start) < 0)
+                return -1;
+            in = fopen(job->path, "rb");
+            if (!in || fseek(in, 0, SEEK_END) < 0 || (size = ftell(in)) <= 0) {
+                perror(job->path);
+                return -1;
+            }
+            rewind(in);
+            job->end = job->start + (unsigned long)size - 1;
+            job->data = malloc((size_t)size);
+            if (!job->data || fread(job->data, 1, (size_t)size, in) != (size_t)size) {
+                perror(job->path);
+                return -1;
+            }
+            fclose(in);
+            i += 3;
+        } else {
+            return -1;
+        }
+
+        if (job->end < job->start || (job->space == 'X' && job->end > XRAM_END)) {
+            fprintf(stderr, "bt_pipe: invalid range %04lX-%04lX\n", job->start, job->end);
+            return -1;
+        }
+        if (job->kind == REQUEST_READ) {
+            job->data = malloc(job->end - job->start + 1);
+            if (!job->data) {
+                perror("bt_pipe");
+                return -1;
+            }
+        }
+        count++;
+    }
+    return count;
+}
+
+static unsigned long count_requests(const job_t *jobs, int job_count, unsigned long chunk) {
+    unsigned long count = 0;
+
+    for (int i = 0; i < job_count; i++) {
+        unsigned long size = jobs[i].end - jobs[i].start + 1;
+
+        if (jobs[i].kind == REQUEST_READ)
+            count += (size + chunk - 1) / chunk;
+        else if (jobs[i].kind == REQUEST_WRITE)
+            count += (size + REQUEST_WRITE_MAX - 1) / REQUEST_WRITE_MAX;
+        else
+            count++;
+    }
+    return count;
+}
+
+static void build_requests(job_t *jobs, int job_count, unsigned long chunk, pipe_request_t *requests) {
+    pipe_request_t *request = requests;
+
+    for (int i = 0; i < job_count; i++) {
+        job_t *job = &jobs[i];
+        unsigned long total = job->end - job->start + 1;
+        unsigned long step = (job->kind == REQUEST_WRITE) ? REQUEST_WRITE_MAX :
+                             (job->kind == REQUEST_READ) ? chunk : total;
+
+        for (unsigned long offset = 0; offset < total; offset += step, request++) {
+            unsigned long first = job->start + offset;
+            unsigned long size = (total - offset < step) ? total - offset : step;
+            unsigned long last = first + size - 1;
+
+            request->op = (uint8_t)job->kind;
+            request->job = job;
+            request->offset = offset;
+            request->size = size;
+            if (job->kind == REQUEST_WRITE) {
+                request->payload[0] = (uint8_t)(first >> 8);
+                request->payload[1] = (uint8_t)first;
+                memcpy(request->payload + 2, job->data + offset, size);
+                request->len = (uint8_t)(2 + size);
+            } else {
+                request->payload[0] = (uint8_t)job->space;
+                request->payload[1] = (uint8_t)(first >> 8);
+                request->payload[2] = (uint8_t)first;
+                request->payload[3] = (uint8_t)(last >> 8);
+                request->payload[4] = (uint8_t)last;
+                request->len = RANGE_PAYLOAD_LENGTH;
+            }
+        }
+    }
+}
+
+static int send_one(int fd, const pipe_request_t *requests, unsigned long index) {
+    const pipe_request_t *request = &requests[index];
+
+    return request_send(fd, (uint8_t)index, request->op, request->payload, request->len);
+}
+
+/*
+ * Collects the replies to one request. Returns 0 when it is complete, 1
+ * for a transmission error worth a retry, and -1 when the target rejected
+ * the request itself.
+ */
+static int receive_one(int fd, const pipe_request_t *request, uint8_t seq) {
+    unsigned long received = 0;
+    reply_t reply;
+    frame_status_t status;
+
+    for (;;) {
+        status = reply_receive(fd, &reply);
+        if (status != FRAME_OK) {
+            fprintf(stderr, "bt_pipe: %s in reply %u\n", frame_status_name(status), seq);
+            return 1;
+        }
+        if (reply.seq != seq) {
+            fprintf(stderr, "bt_pipe: expected reply %u, got %u\n", seq, reply.seq);
+            return 1;
+        }
+        if (reply.type == REPLY_DATA) {
+            if (request->op != REQUEST_READ || received + reply.len > request->size)
+                return 1;
+            memcpy(request->job->data + request->offset + received, reply.payload, reply.len);
+            received += reply.len;
+            continue;
+        }
+        if (reply.type != REPLY_END || reply.len == 0)
+            return 1;
+        break;
+    }
+
+    if (reply.payload[0] == REQUEST_BAD_CRC) {
+        fprintf(stderr, "bt_pipe: target saw a corrupted request %u\n", seq);
+        return 1;
+    }
+    if (reply.payload[0] != REQUEST_OK) {
+        fprintf(stderr, "bt_pipe: request %u: %s\n", seq, request_status_name(reply.payload[0]));
+        return -1;
+    }
+    if (request->op == REQUEST_READ && received != request->size)
+        return 1;
+    if (request->op == REQUEST_CRC) {
+        if (reply.len != 7)
+            return 1;
+        printf("%c %04lX-%04lX CRC16: %02X%02X  CRC32: %02X%02X%02X%02X\n",
+               request->job->space, request->job->start, request->job->end,
+               reply.payload[1], reply.payload[2], reply.payload[3],
+               reply.payload[4], reply.payload[5], reply.payload[6]);
+    }
+    return 0;
+}
+
+static int finish_jobs(const job_t *jobs, int job_count) {
+    for (int i = 0; i < job_count; i++) {
+        unsigned long size = jobs[i].end - jobs[i].start + 1;
+        FILE *out;
+
+        if (jobs[i].kind != REQUEST_READ)
+            continue;
+        out = fopen(jobs[i].path, "wb");
+        if (!out || fwrite(jobs[i].data, 1, size, out) != size) {
+            perror(jobs[i].path);
+            return -1;
+        }
+        fclose(out);
+        printf("%c %04lX-%04lX: %lu bytes written to %s\n",
+               jobs[i].space, jobs[i].start, jobs[i].end, size, jobs[i].path);
+    }
+    return 0;
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char **argv) {
+    long initial_baud = SERIAL_DEFAULT_BAUD;
+    long baud = 0;
+    unsigned long window = 0, chunk = DEFAULT_CHUNK;
+    unsigned long count, sent = 0, done = 0, bytes = 0, resent = 0;
+    int opt, fd, job_count, retries = 0;
+    job_t *jobs;
+    pipe_request_t *requests;
+    reply_t hello;
+    uint8_t flush[FLUSH_BYTES] = { 0 };
+    double start;
+
+    while ((opt = getopt(argc, argv, "i:b:w:c:")) != -1) {
+        if (opt == 'i')
+            initial_baud = strtol(optarg, NULL, 10);
+        else if (opt == 'b')
+            baud = strtol(optarg, NULL, 10);
+        else if (opt == 'w')
+            window = strtoul(optarg, NULL, 10);
+        else if (opt == 'c')
+            chunk = strtoul(optarg, NULL, 10);
+        else
+            usage();
+    }
+    if (argc - optind < 2 || chunk == 0 || chunk > 0x10000 || window > MAX_WINDOW)
+        usage();
+
+    jobs = calloc((size_t)(argc - optind), sizeof(*jobs));
+    if (!jobs)
+        return 1;
+    job_count = parse_jobs(argc - optind - 1, argv + optind + 1, jobs);
+    if (job_count <= 0)
+        usage();
+    count = count_requests(jobs, job_count, chunk);
+    requests = calloc(count, sizeof(*requests));
+    if (!requests) {
+        perror("bt_pipe");
+        return 1;
+    }
+    build_requests(jobs, job_count, chunk, requests);
+
+    fd = serial_open(argv[optind], initial_baud);
+    if (fd < 0)
+        return 1;
+    if (baud && serial_negotiate_baud(fd, initial_baud, baud) < 0)
+        return 1;
+
+    if (serial_write(fd, "Q", 1) < 0)
+        return 1;
+    if (reply_receive(fd, &hello) != FRAME_OK || hello.type != REPLY_HELLO || hello.len < 2 ||
+        hello.payload[0] != REQUEST_VERSION) {
+        fprintf(stderr, "bt_pipe: target did not enter request mode\n");
+        return 1;
+    }
+    if (window == 0 || window > hello.payload[1])
+        window = hello.payload[1];
+    fprintf(stderr, "bt_pipe: %lu requests, window %lu\n", count, window);
+
+    start = now_seconds();
+    while (done < count) {
+        int result;
+
+        while (sent < count && sent - done < window) {
+            if (send_one(fd, requests, sent) < 0)
+                return 1;
+            sent++;
+        }
+
+        result = receive_one(fd, &requests[done], (uint8_t)done);
+        if (result < 0)
+            return 1;
+        if (result == 0) {
+            if (requests[done].op != REQUEST_CRC)
+                bytes += requests[done].size;
+            done++;
+            retries = 0;
+            fprintf(stderr, "\r%lu / %lu", done, count);
+            continue;
+        }
+
+        // Go back: complete whatever the target is still reading, let
+        // every reply in flight pass, then resend from the failed request
+        if (++retries > MAX_RETRIES) {
+            fprintf(stderr, "bt_pipe: giving up at request %lu\n", done);
+            return 1;
+        }
+        if (serial_write(fd, flush, sizeof(flush)) < 0)
+            return 1;
+        serial_drain(fd, QUIET_MS);
+        resent += sent - done;
+        sent = done;
+    }
+    fprintf(stderr, "\n");
+
+    if (request_send(fd, (uint8_t)count, REQUEST_QUIT, NULL, 0) < 0)
+        return 1;
+    serial_drain(fd, QUIET_MS);
+    fprintf(stderr, "bt_pipe: %lu bytes in %.2f s, %lu requests resent\n",
+            bytes, now_seconds() - start, resent);
+
+    if (finish_jobs(jobs, job_count) < 0)
+        return 1;
+    close(fd);
+    return 0;
+}
@@ -0,0 +1,270 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    cond.c
+ * @brief   Recursive-descent compiler for breakpoint conditions.
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+#include <ctype.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cond.h"
+
+// Register operands, index = COND_REG argument (snapshot frame order)
+static const char *const register_names[] = {
+    "acc", "b", "psw", "dph", "dpl",
+    "r0", "r1", "r2", "r3", "r4", "r5", "r6", "r7",
+    "sp", "dptr", "pc"
+};
+#define REGISTER_COUNT (sizeof(register_names) / sizeof(register_names[0]))
+
+typedef struct {
+    const char *p;
+    uint8_t *out;
+    size_t len;
+    int depth;
+    int failed;
+    char *error;
+    size_t error_size;
+} compiler_t;
+
+// One precedence level: operator spellings and their opcodes
+typedef struct {
+    const char *text;
+    uint8_t op;
+} binary_op_t;
+
+static const binary_op_t lor_ops[] = { { "||", COND_LOR }, { NULL, 0 } };
+static const binary_op_t land_ops[] = { { "&&", COND_LAND }, { NULL, 0 } };
+static const binary_op_t or_ops[] = { { "|", COND_OR }, { NULL, 0 } };
+static const binary_op_t xor_ops[] = { { "^", COND_XOR }, { NULL, 0 } };
+static const binary_op_t and_ops[] = { { "&", COND_AND }, { NULL, 0 } };
+static const binary_op_t eq_ops[] = { { "==", COND_EQ }, { "!=", COND_NE }, { NULL, 0 } };
+static const binary_op_t rel_ops[] = {
+    { "<=", COND_LE }, { ">=", COND_GE }, { "<", COND_LT }, { ">", COND_GT }, { NULL, 0 }
+};
+static const binary_op_t add_ops[] = { { "+", COND_ADD }, { "-", COND_SUB }, { NULL, 0 } };
+static const binary_op_t mod_ops[] = { { "%", COND_MOD }, { NULL, 0 } };
+
+static const binary_op_t *const levels[] = {
+    lor_ops, land_ops, or_ops, xor_ops, and_ops, eq_ops, rel_ops, add_ops, mod_ops
+};
+#define LEVEL_COUNT (sizeof(levels) / sizeof(levels[0]))
+
+
+static void fail(compiler_t *c, const char *format, ...);
+static void emit(compiler_t *c, uint8_t byte);
+static void push(compiler_t *c);
+static void skip_space(compiler_t *c);
+static int accept(compiler_t *c, const char *text);
+static void parse_level(compiler_t *c, size_t level);
+static void parse_unary(compiler_t *c);
+static void parse_primary(compiler_t *c);
+
+
+static void fail(compiler_t *c, const char *format, ...) {
+    va_list args;
+
+    if (c->failed)
+        return;
+    c->failed = 1;
+    va_start(args, format);
+    vsnprintf(c->error, c->error_size, format, args);
+    va_end(args);
+}
+
+static void emit(compiler_t *c, uint8_t byte) {
+    if (c->len >= COND_MAX - 1) {
+        fail(c, "condition does not fit in %d bytes", COND_MAX - 1);
+        return;
+    }
+    c->out[c->len++] = byte;
+}
+
+static void push(compiler_t *c) {
+    if (++c->depth > COND_STACK_DEPTH)
+        fail(c, "condition nests deeper than %d values", COND_STACK_DEPTH);
+}
+
+static void skip_space(compiler_t *c) {
+    while (isspace((unsigned char)*c->p))
+        c->p++;
+}
+
+static int accept(compiler_t *c, const char *text) {
+    size_t n = strlen(text);
+
+    skip_space(c);
+    if (strncmp(c->p, text, n) != 0)
+        return 0;
+    // Keep "|" from matching the first half of "||" and so on
+    if (n == 1 && (text[0] == '|' || text[0] == '&') && c->p[1] == text[0])
+        return 0;
+    if (n == 1 && (text[0] == '<' || text[0] == '>') && c->p[1] == '=')
+        return 0;
+    c->p += n;
+    return 1;
+}
+
+static void parse_level(compiler_t *c, size_t level) {
+    if (level == LEVEL_COUNT) {
+        parse_unary(c);
+        return;
+    }
+    parse_level(c, level + 1);
+    for (;;) {
+        const binary_op_t *op;
+
+        for (op = levels[level]; op->text; op++) {
+            if (accept(c, op->text))
+                break;
+        }
+        if (!op->text || c->failed)
+            return;
+        parse_level(c, level + 1);
+        emit(c, op->op);
+        c->depth--;
+    }
+}
+
+static void parse_unary(compiler_t *c) {
+    if (accept(c, "!")) {
+        parse_unary(c);
+        emit(c, COND_NOT);
+        return;
+    }
+    parse_primary(c);
+}
+
+static void parse_primary(compiler_t *c) {
+    char name[8];
+    size_t n = 0;
+
+    skip_space(c);
+    if (accept(c, "(")) {
+        parse_level(c, 0);
+        if (!accept(c, ")"))
+            fail(c, "missing ')'");
+        return;
+    }
+
+    if (isdigit((unsigned char)*c->p)) {
+        char *end;
+        unsigned long value = strtoul(c->p, &end, 0);
+
+        if (value > 0xFFFF) {
+            fail(c, "constant %lu does not fit in 16 bits", value);
+            return;
+        }
+        c->p = end;
+        if (value <= 0xFF) {
+            emit(c, COND_LIT8);
+        } else {
+            emit(c, COND_LIT16);
+            emit(c, (uint8_t)(value >> 8));
+        }
+        emit(c, (uint8_t)value);
+        push(c);
+        return;
+    }
+
+    while (isalnum((unsigned char)*c->p) && n < sizeof(name) - 1)
+        name[n++] = (char)tolower((unsigned char)*c->p++);
+    name[n] = '\0';
+    if (n == 0) {
+        fail(c, *c->p ? "unexpected '%c'" : "unexpected end of condition", *c->p);
+        return;
+    }
+
+    if (strcmp(name, "hits") == 0) {
+        emit(c, COND_HITS);
+        push(c);
+        return;
+    }
+    if (strcmp(name, "xram") == 0) {
+        if (!accept(c, "[")) {
+            fail(c, "expected '[' after xram");
+            return;
+        }
+        parse_level(c, 0);
+        if (!accept(c, "]"))
+            fail(c, "missing ']'");
+        emit(c, COND_XRAM);
+        return;
+    }
+    if (strcmp(name, "a") == 0)
+        strcpy(name, "acc");
+    for (size_t i = 0; i < REGISTER_COUNT; i++) {
+        if (strcmp(name, register_names[i]) == 0) {
+            emit(c, COND_REG);
+            emit(c, (uint8_t)i);
+            push(c);
+            return;
+        }
+    }
+    fail(c, "unknown operand '%s'", name);
+}
+
+int cond_compile(const char *text, uint8_t *program, size_t *length,
+                 char *error, size_t error_size) {
+    compiler_t c = { text, program, 0, 0, 0, error, error_size };
+
+    skip_space(&c);
+    if (*c.p) {
+        parse_level(&c, 0);
+        skip_space(&c);
+        if (*c.p)
+            fail(&c, "unexpected '%c'", *c.p);
+    }
+    *length = c.len;
+    return c.failed ? -1 : 0;
+}
+
+void cond_disassemble(const uint8_t *program, size_t length) {
+    static const struct { uint8_t op; const char *name; } names[] = {
+        { COND_XRAM, "xram" }, { COND_NOT, "!" },
+        { COND_EQ, "==" }, { COND_NE, "!=" }, { COND_LT, "<" }, { COND_LE, "<=" },
+        { COND_GT, ">" }, { COND_GE, ">=" }, { COND_ADD, "+" }, { COND_SUB, "-" },
+        { COND_AND, "&" }, { COND_OR, "|" }, { COND_XOR, "^" }, { COND_MOD, "%" },
+        { COND_LAND, "&&" }, { COND_LOR, "||" }
+    };
+
+    for (size_t i = 0; i < length; i++) {
+        uint8_t op = program[i];
+
+        printf("  %02X  ", op);
+        if (op == COND_LIT8 && i + 1 < length) {
+            printf("push %u\n", program[++i]);
+        } else if (op == COND_LIT16 && i + 2 < length) {
+            printf("push 0x%04X\n", (program[i + 1] << 8) | program[i + 2]);
+            i += 2;
+        } else if (op == COND_REG && i + 1 < length) {
+            uint8_t r = program[++i];
+            printf("push %s\n", r < REGISTER_COUNT ? register_names[r] : "?");
+        } else if (op == COND_HITS) {
+            printf("push hits\n");
+        } else {
+            const char *name = "?";
+
+            for (size_t k = 0; k < sizeof(names) / sizeof(names[0]); k++) {
+                if (names[k].op == op)
+                    name = names[k].name;
+            }
+            printf("%s\n", name);
+        }
+    }
+}
@@ -0,0 +1,83 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    cond.h
+ * @brief   Header file for the breakpoint condition compiler.
+ * @details Translates expressions such as "hits == 500 && dptr > 0x1F00"
+ *          into the postfix bytecode run by the monitor's INT1 handler
+ *          (opcodes as in Single_Step_Keil_Compiler/cone.c).
+ *
+ *          Operands: acc (or a), b, psw, dph, dpl, r0-r7, sp, dptr, pc,
+ *          hits, xram[expr], decimal or 0x hex constants. Operators by
+ *          rising precedence: ||, &&, |, ^, &, == !=, < <= > >=, + -, %,
+ *          unary !. All arithmetic is unsigned 16-bit.
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+
+#ifndef _cond_H_
+#define _cond_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define COND_MAX (32)           // Target buffer, including the end marker
+#define COND_STACK_DEPTH (6)
+
+#define COND_END (0x00)
+#define COND_LIT8 (0x01)
+#define COND_LIT16 (0x02)
+#define COND_REG (0x03)
+#define COND_HITS (0x04)
+#define COND_XRAM (0x08)
+#define COND_NOT (0x09)
+#define COND_EQ (0x10)
+#define COND_NE (0x11)
+#define COND_LT (0x12)
+#define COND_LE (0x13)
+#define COND_GT (0x14)
+#define COND_GE (0x15)
+#define COND_ADD (0x20)
+#define COND_SUB (0x21)
+#define COND_AND (0x22)
+#define COND_OR (0x23)
+#define COND_XOR (0x24)
+#define COND_MOD (0x25)
+#define COND_LAND (0x30)
+#define COND_LOR (0x31)
+
+/**
+ * @brief   Compiles a condition expression to target bytecode.
+ * @details The end marker is not emitted; the monitor appends it. An empty
+ *          expression compiles to an empty program, which removes the
+ *          condition.
+ * @param   text - Expression source.
+ * @param   program - Receives at most COND_MAX - 1 bytes.
+ * @param   length - Receives the number of bytes written.
+ * @param   error - Receives a message on failure.
+ * @param   error_size - Size of the error buffer.
+ * @return  0 on success, -1 on error.
+ */
+int cond_compile(const char *text, uint8_t *program, size_t *length,
+                 char *error, size_t error_size);
+
+/**
+ * @brief   Prints a program as a postfix listing, one operation per line.
+ * @param   program - Bytecode.
+ * @param   length - Number of bytes.
+ * @return  None
+ */
+void cond_disassemble(const uint8_t *program, size_t length);
+
+#endif
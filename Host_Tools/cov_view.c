@@ -0,0 +1,332 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    cov_view.c
+ * @brief   Overlays the monitor's coverage bitmap on SDCC listings.
+ * @details Sends 'C' 'D', receives the bitmap (one bit per code address)
+ *          and marks every instruction line of the given .rst or .lst
+ *          files as executed or not. Functions are the global labels of
+ *          the listing; SDCC local labels (00104$) do not start one.
+ *
+ *          Usage: cov_view [-i baud] [-b baud] [-o raw] [-a offset] [-l] <port> <listing>...
+ *                 cov_view [-a offset] [-l] -f raw <listing>...
+ *
+ *          Without -l only the per-function summary is printed; with -l
+ *          the listing itself follows, each instruction prefixed with '+'
+ *          (reached) or '-' (never reached). .rst files carry final
+ *          addresses; a .lst is relative to each area, so -a adds the
+ *          CSEG start from the .map and only the CSEG lines come out right.
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+#include <ctype.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "serial.h"
+
+// Download format, see coverage_download() in Single_Step_Keil_Compiler/cone.c
+#define COVERAGE_DUMP_SYNC (0x5C)
+#define COVERAGE_HEADER (4)
+#define COVERAGE_SIZE_MAX (0x2000)
+#define COVERAGE_TIMEOUT_MS (2000)
+#define QUIET_MS (300)
+#define LINE_MAX_LENGTH (512)
+
+typedef struct {
+    unsigned base;
+    unsigned size;
+    uint8_t map[COVERAGE_SIZE_MAX];
+} coverage_t;
+
+typedef struct {
+    char name[64];
+    unsigned address;
+    unsigned instructions;
+    unsigned reached;
+} function_t;
+
+
+static void usage(void);
+static int receive_coverage(int fd, coverage_t *coverage);
+static int reached(const coverage_t *coverage, unsigned address);
+static int parse_line(const char *line, unsigned *address, int *instruction, char *label);
+static int overlay(const char *path, const coverage_t *coverage, unsigned offset, int listing);
+
+
+static void usage(void) {
+    fprintf(stderr, "usage: cov_view [-i baud] [-b baud] [-o raw] [-a offset] [-l] <port> <listing>...\n"
+                    "       cov_view [-a offset] [-l] -f raw <listing>...\n");
+    exit(2);
+}
+
+static int receive_coverage(int fd, coverage_t *coverage) {
+    uint8_t header[COVERAGE_HEADER];
+    unsigned sum = 0;
+    int c, hi, lo;
+
+    if (serial_write(fd, "CD", 2) < 0)
+        return -1;
+    do {
+        c = serial_read_byte(fd, COVERAGE_TIMEOUT_MS);
+        if (c < 0) {
+            fprintf(stderr, "cov_view: no coverage from the monitor\n");
+            return -1;
+        }
+    } while (c != COVERAGE_DUMP_SYNC);
+
+    for (int i = 0; i < COVERAGE_HEADER; i++) {
+        c = serial_read_byte(fd, COVERAGE_TIMEOUT_MS);
+        if (c < 0) {
+            fprintf(stderr, "cov_view: timeout in header\n");
+            return -1;
+        }
+        header[i] = (uint8_t)c;
+        sum += (unsigned)c;
+    }
+    coverage->base = (header[0] << 8) | header[1];
+    coverage->size = (header[2] << 8) | header[3];
+    if (coverage->size > COVERAGE_SIZE_MAX) {
+        fprintf(stderr, "cov_view: bad bitmap size %u\n", coverage->size);
+        return -1;
+    }
+
+    for (unsigned i = 0; i < coverage->size; i++) {
+        c = serial_read_byte(fd, COVERAGE_TIMEOUT_MS);
+        if (c < 0) {
+            fprintf(stderr, "cov_view: timeout at byte %u\n", i);
+            return -1;
+        }
+        coverage->map[i] = (uint8_t)c;
+        sum += (unsigned)c;
+    }
+    hi = serial_read_byte(fd, COVERAGE_TIMEOUT_MS);
+    lo = serial_read_byte(fd, COVERAGE_TIMEOUT_MS);
+    if (hi < 0 || lo < 0 || (uint16_t)sum != (uint16_t)((hi << 8) | lo)) {
+        fprintf(stderr, "cov_view: checksum mismatch\n");
+        return -1;
+    }
+    return 0;
+}
+
+static int reached(const coverage_t *coverage, unsigned address) {
+    unsigned offset = (address - coverage->base) & 0xFFFF;
+
+    if (offset >= coverage->size * 8)
+        return -1;
+    return (coverage->map[offset >> 3] >> (offset & 7)) & 1;
+}
+
+/*
+ * Listing lines look like
+ *   "      0040A0 75 E0 11         [24]  616 \tmov\t_ACC,#0x11"
+ *   "      00409D                        610 _main:"
+ * The cycle count in brackets marks an instruction; a label line has an
+ * address and "name:" after the source line number.
+ */
+static int parse_line(const char *line, unsigned *address, int *instruction, char *label) {
+    const char *p = line;
+    char *end;
+    size_t length;
+
+    *instruction = 0;
+    label[0] = '\0';
+    while (*p == ' ')
+        p++;
+    if (!isxdigit((unsigned char)*p))
+        return 0;
+    *address = (unsigned)strtoul(p, &end, 16);
+    if (end - p != 6 || *end != ' ')
+        return 0;
+
+    p = strchr(end, '[');
+    if (p && isdigit((unsigned char)p[1]) && p - line < 40) {
+        *instruction = 1;
+        return 1;
+    }
+
+    // Skip the source line number, then look for "label:"
+    p = end;
+    while (*p == ' ')
+        p++;
+    while (isdigit((unsigned char)*p))
+        p++;
+    if (*p != ' ')
+        return 1;
+    p++;
+    length = strcspn(p, ":\r\n\t ");
+    if (length && length < 64 && p[length] == ':' && p[length - 1] != '$') {
+        memcpy(label, p, length);
+        label[length] = '\0';
+    }
+    return 1;
+}
+
+static int overlay(const char *path, const coverage_t *coverage, unsigned offset, int listing) {
+    FILE *in = fopen(path, "r");
+    char line[LINE_MAX_LENGTH];
+    function_t *functions = NULL;
+    size_t count = 0, capacity = 0;
+    unsigned total = 0, total_reached = 0, outside = 0;
+
+    if (!in) {
+        perror(path);
+        return -1;
+    }
+    if (listing)
+        printf("\n%s\n", path);
+
+    while (fgets(line, sizeof(line), in)) {
+        unsigned address;
+        int instruction;
+        char label[64];
+        char mark = ' ';
+
+        if (parse_line(line, &address, &instruction, label)) {
+            address = (address + offset) & 0xFFFF;
+            if (label[0]) {
+                if (count == capacity) {
+                    capacity = capacity ? capacity * 2 : 32;
+                    functions = realloc(functions, capacity * sizeof(function_t));
+                    if (!functions) {
+                        perror("cov_view");
+                        exit(1);
+                    }
+                }
+                memset(&functions[count], 0, sizeof(function_t));
+                strcpy(functions[count].name, label);
+                functions[count].address = address;
+                count++;
+            } else if (instruction) {
+                int hit = reached(coverage, address);
+
+                if (hit < 0) {
+                    outside++;
+                    mark = '?';
+                } else {
+                    mark = hit ? '+' : '-';
+                    total++;
+                    total_reached += hit;
+                    if (count) {
+                        functions[count - 1].instructions++;
+                        functions[count - 1].reached += hit;
+                    }
+                }
+            }
+        }
+        if (listing)
+            printf("%c %s", mark, line);
+    }
+    fclose(in);
+
+    printf("\n%s: %u of %u instructions reached (%.1f%%)\n", path, total_reached, total,
+           total ? 100.0 * total_reached / total : 0.0);
+    if (outside)
+        printf("  %u instructions outside the bitmap\n", outside);
+    printf("  reached  total      %%  address  function\n");
+    for (size_t i = 0; i < count; i++) {
+        if (!functions[i].instructions)
+            continue;
+        printf("%9u %6u %6.1f  %04X     %s%s\n", functions[i].reached, functions[i].instructions,
+               100.0 * functions[i].reached / functions[i].instructions, functions[i].address,
+               functions[i].name, functions[i].reached ? "" : "  (never run)");
+    }
+    free(functions);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    long initial_baud = SERIAL_DEFAULT_BAUD;
+    long baud = 0;
+    unsigned offset = 0;
+    int listing = 0;
+    const char *raw_out = NULL, *raw_in = NULL;
+    static coverage_t coverage;
+    int status = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "i:b:o:a:lf:")) != -1) {
+        if (opt == 'i')
+            initial_baud = strtol(optarg, NULL, 10);
+        else if (opt == 'b')
+            baud = strtol(optarg, NULL, 10);
+        else if (opt == 'o')
+            raw_out = optarg;
+        else if (opt == 'a')
+            offset = (unsigned)strtoul(optarg, NULL, 16);
+        else if (opt == 'l')
+            listing = 1;
+        else if (opt == 'f')
+            raw_in = optarg;
+        else
+            usage();
+    }
+
+    if (raw_in) {
+        FILE *in = fopen(raw_in, "rb");
+        uint8_t header[COVERAGE_HEADER];
+
+        if (argc - optind < 1)
+            usage();
+        if (!in || fread(header, 1, sizeof(header), in) != sizeof(header)) {
+            fprintf(stderr, "cov_view: cannot read %s\n", raw_in);
+            return 1;
+        }
+        coverage.base = (header[0] << 8) | header[1];
+        coverage.size = (header[2] << 8) | header[3];
+        if (coverage.size > COVERAGE_SIZE_MAX ||
+            fread(coverage.map, 1, coverage.size, in) != coverage.size) {
+            fprintf(stderr, "cov_view: %s is truncated\n", raw_in);
+            return 1;
+        }
+        fclose(in);
+    } else {
+        int fd;
+
+        if (argc - optind < 2)
+            usage();
+        fd = serial_open(argv[optind], initial_baud);
+        if (fd < 0)
+            return 1;
+        if (baud && serial_negotiate_baud(fd, initial_baud, baud) < 0)
+            return 1;
+        serial_drain(fd, QUIET_MS);
+        if (receive_coverage(fd, &coverage) < 0)
+            return 1;
+        serial_drain(fd, QUIET_MS);
+        close(fd);
+        optind++;
+        if (raw_out) {
+            FILE *out = fopen(raw_out, "wb");
+            uint8_t header[COVERAGE_HEADER] = {
+                coverage.base >> 8, coverage.base & 0xFF, coverage.size >> 8, coverage.size & 0xFF
+            };
+
+            if (!out || fwrite(header, 1, sizeof(header), out) != sizeof(header) ||
+                fwrite(coverage.map, 1, coverage.size, out) != coverage.size) {
+                perror(raw_out);
+                return 1;
+            }
+            fclose(out);
+        }
+    }
+
+    for (int i = optind; i < argc; i++) {
+        if (overlay(argv[i], &coverage, offset, listing) < 0)
+            status = 1;
+    }
+    return status;
+}
@@ -0,0 +1,52 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    crc.h
+ * @brief   Header file for the host-side CRC routines.
+ * @details Bitwise versions of the target's table-driven CRC-16/CCITT-FALSE
+ *          and CRC-32, so a table mistake on either side shows up as a
+ *          mismatch instead of cancelling out.
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+
+#ifndef _crc_H_
+#define _crc_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define CRC16_INIT (0xFFFF)
+#define CRC32_INIT (0xFFFFFFFFUL)
+#define CRC32_FINAL_XOR (0xFFFFFFFFUL)
+
+/**
+ * @brief   Feeds a buffer into a running CRC-16/CCITT-FALSE.
+ * @param   crc - CRC so far (start with CRC16_INIT).
+ * @param   data - Bytes to add.
+ * @param   len - Number of bytes.
+ * @return  The updated CRC.
+ */
+uint16_t crc16_ccitt(uint16_t crc, const uint8_t *data, size_t len);
+
+/**
+ * @brief   Feeds a buffer into a running CRC-32.
+ * @param   crc - CRC so far (start with CRC32_INIT).
+ * @param   data - Bytes to add.
+ * @param   len - Number of bytes.
+ * @return  The updated CRC; XOR with CRC32_FINAL_XOR when done.
+ */
+uint32_t crc32_update(uint32_t crc, const uint8_t *data, size_t len);
+
+#endif
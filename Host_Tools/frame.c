@@ -0,0 +1,76 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    frame.c
+ * @brief   Implements host-side frame decoding for the binary protocol.
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+#include "crc.h"
+#include "frame.h"
+#include "serial.h"
+
+
+frame_status_t frame_receive(int fd, frame_t *frame) {
+    uint8_t header[2];
+    int c;
+    int hi, lo;
+    uint16_t crc;
+
+    // Skip command echo and prompt text until the sync byte
+    do {
+        c = serial_read_byte(fd, FRAME_TIMEOUT_MS);
+        if (c < 0)
+            return FRAME_TIMEOUT;
+    } while (c != FRAME_SYNC);
+
+    for (int i = 0; i < 2; i++) {
+        c = serial_read_byte(fd, FRAME_TIMEOUT_MS);
+        if (c < 0)
+            return FRAME_TIMEOUT;
+        header[i] = (uint8_t)c;
+    }
+    frame->seq = header[0];
+    frame->len = header[1];
+    if (frame->len > FRAME_PAYLOAD_MAX)
+        return FRAME_BAD_LENGTH;
+
+    for (int i = 0; i < frame->len; i++) {
+        c = serial_read_byte(fd, FRAME_TIMEOUT_MS);
+        if (c < 0)
+            return FRAME_TIMEOUT;
+        frame->payload[i] = (uint8_t)c;
+    }
+
+    hi = serial_read_byte(fd, FRAME_TIMEOUT_MS);
+    lo = serial_read_byte(fd, FRAME_TIMEOUT_MS);
+    if (hi < 0 || lo < 0)
+        return FRAME_TIMEOUT;
+
+    crc = crc16_ccitt(CRC16_INIT, header, 2);
+    crc = crc16_ccitt(crc, frame->payload, frame->len);
+    if (crc != (uint16_t)((hi << 8) | lo))
+        return FRAME_BAD_CRC;
+    return FRAME_OK;
+}
+
+const char *frame_status_name(frame_status_t status) {
+    switch (status) {
+        case FRAME_OK:         return "ok";
+        case FRAME_TIMEOUT:    return "timeout";
+        case FRAME_BAD_CRC:    return "CRC mismatch";
+        case FRAME_BAD_LENGTH: return "bad length";
+        default:               return "unknown";
+    }
+}
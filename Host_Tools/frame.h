@@ -0,0 +1,62 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    frame.h
+ * @brief   Header file for decoding the editor's binary frames on the host.
+ * @details Frame layout (see Memory_Interpretation_SDCC/src/frame.h):
+ *          0x7E, seq, len, payload[len], crc16 (hi, lo). The CRC is
+ *          CRC-16/CCITT-FALSE over seq, len and the payload.
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+
+#ifndef _frame_H_
+#define _frame_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define FRAME_SYNC (0x7E)
+#define FRAME_PAYLOAD_MAX (64)
+#define FRAME_TIMEOUT_MS (2000)
+
+typedef enum {
+    FRAME_OK = 0,
+    FRAME_TIMEOUT,
+    FRAME_BAD_CRC,
+    FRAME_BAD_LENGTH
+} frame_status_t;
+
+typedef struct {
+    uint8_t seq;
+    uint8_t len;
+    uint8_t payload[FRAME_PAYLOAD_MAX];
+} frame_t;
+
+/**
+ * @brief   Waits for the next frame and validates it.
+ * @param   fd - Serial port file descriptor.
+ * @param   frame - Receives the decoded frame.
+ * @return  FRAME_OK or the reason the frame was rejected.
+ */
+frame_status_t frame_receive(int fd, frame_t *frame);
+
+/**
+ * @brief   Returns a short description of a frame status.
+ * @param   status - Status returned by frame_receive().
+ * @return  Static string.
+ */
+const char *frame_status_name(frame_status_t status);
+
+#endif
@@ -0,0 +1,56 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    hex_crc.c
+ * @brief   Computes the memory editor's range checksums from an Intel HEX file.
+ * @details Prints the same "CRC16: xxxx  CRC32: xxxxxxxx" line as the 'K'
+ *          command, so a flashed image can be verified by comparing one line.
+ *          Without a range the whole span covered by the file is used.
+ *
+ *          Usage: hex_crc <file.hex> [<start> <end>]
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "crc.h"
+#include "ihex.h"
+
+
+int main(int argc, char **argv) {
+    static uint8_t image[IHEX_IMAGE_SIZE];
+    unsigned start, end;
+    uint16_t crc16;
+    uint32_t crc32;
+
+    if (argc != 2 && argc != 4) {
+        fprintf(stderr, "usage: hex_crc <file.hex> [<start> <end>]\n");
+        return 2;
+    }
+    if (ihex_load(argv[1], image, &start, &end) < 0)
+        return 1;
+    if (argc == 4) {
+        start = (unsigned)strtoul(argv[2], NULL, 16);
+        end = (unsigned)strtoul(argv[3], NULL, 16);
+        if (end < start || end > 0xFFFF) {
+            fprintf(stderr, "hex_crc: invalid range\n");
+            return 2;
+        }
+    }
+
+    crc16 = crc16_ccitt(CRC16_INIT, image + start, end - start + 1);
+    crc32 = crc32_update(CRC32_INIT, image + start, end - start + 1) ^ CRC32_FINAL_XOR;
+    printf("%04X-%04X CRC16: %04X  CRC32: %08lX\n", start, end, crc16, (unsigned long)crc32);
+    return 0;
+}
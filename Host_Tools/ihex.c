@@ -0,0 +1,123 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    ihex.c
+ * @brief   Implements the Intel HEX loader.
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+#include "ihex.h"
+
+#define IHEX_LINE_MAX (600)
+#define IHEX_TYPE_DATA (0x00)
+#define IHEX_TYPE_EOF (0x01)
+
+
+static int hex_byte(const char *text, unsigned *value);
+
+
+static int hex_byte(const char *text, unsigned *value) {
+    unsigned v = 0;
+
+    for (int i = 0; i < 2; i++) {
+        char c = text[i];
+        v <<= 4;
+        if (c >= '0' && c <= '9')
+            v |= (unsigned)(c - '0');
+        else if (c >= 'A' && c <= 'F')
+            v |= (unsigned)(c - 'A' + 10);
+        else if (c >= 'a' && c <= 'f')
+            v |= (unsigned)(c - 'a' + 10);
+        else
+            return -1;
+    }
+    *value = v;
+    return 0;
+}
+
+int ihex_load(const char *path, uint8_t *image, unsigned *low, unsigned *high) {
+    char line[IHEX_LINE_MAX];
+    unsigned lowest = IHEX_IMAGE_SIZE, highest = 0;
+    unsigned line_number = 0;
+    FILE *in = fopen(path, "r");
+
+    if (!in) {
+        perror(path);
+        return -1;
+    }
+    memset(image, 0xFF, IHEX_IMAGE_SIZE);
+
+    while (fgets(line, sizeof(line), in)) {
+        unsigned count, addr_hi, addr_lo, type, value, sum;
+        unsigned address;
+        size_t length = strcspn(line, "\r\n");
+
+        line_number++;
+        line[length] = '\0';
+        if (length == 0)
+            continue;
+        if (line[0] != ':' || length < 11 ||
+            hex_byte(line + 1, &count) || hex_byte(line + 3, &addr_hi) ||
+            hex_byte(line + 5, &addr_lo) || hex_byte(line + 7, &type) ||
+            length != 11 + count * 2) {
+            fprintf(stderr, "%s:%u: malformed record\n", path, line_number);
+            fclose(in);
+            return -1;
+        }
+
+        sum = count + addr_hi + addr_lo + type;
+        for (unsigned i = 0; i <= count; i++) {
+            if (hex_byte(line + 9 + i * 2, &value)) {
+                fprintf(stderr, "%s:%u: malformed record\n", path, line_number);
+                fclose(in);
+                return -1;
+            }
+            sum += value;
+        }
+        if (sum & 0xFF) {
+            fprintf(stderr, "%s:%u: checksum error\n", path, line_number);
+            fclose(in);
+            return -1;
+        }
+
+        if (type == IHEX_TYPE_EOF)
+            break;
+        if (type != IHEX_TYPE_DATA)
+            continue;
+
+        address = (addr_hi << 8) | addr_lo;
+        for (unsigned i = 0; i < count; i++) {
+            unsigned a = (address + i) & 0xFFFF;
+            hex_byte(line + 9 + i * 2, &value);
+            image[a] = (uint8_t)value;
+            if (a < lowest)
+                lowest = a;
+            if (a > highest)
+                highest = a;
+        }
+    }
+    fclose(in);
+
+    if (lowest > highest) {
+        fprintf(stderr, "%s: no data records\n", path);
+        return -1;
+    }
+    if (low)
+        *low = lowest;
+    if (high)
+        *high = highest;
+    return 0;
+}
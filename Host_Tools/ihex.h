@@ -0,0 +1,50 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    ihex.h
+ * @brief   Header file for the Intel HEX loader.
+ * @details Loads the .hex images produced by packihx (SDCC) and Keil into a
+ *          64 KB image. Bytes not covered by the file are left at 0xFF,
+ *          the erased flash value, so ranges with gaps checksum the same
+ *          as on the target.
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+
+#ifndef _ihex_H_
+#define _ihex_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IHEX_IMAGE_SIZE (0x10000)
+
+/**
+ * @brief   Loads an Intel HEX file into a 64 KB image.
+ * @param   path - Path of the .hex file.
+ * @param   image - IHEX_IMAGE_SIZE bytes, prefilled with 0xFF by the loader.
+ * @param   low - Receives the lowest address loaded (may be NULL).
+ * @param   high - Receives the highest address loaded (may be NULL).
+ * @return  0 on success, -1 on error (message already printed).
+ */
+int ihex_load(const char *path, uint8_t *image, unsigned *low, unsigned *high);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
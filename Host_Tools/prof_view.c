@@ -0,0 +1,262 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    prof_view.c
+ * @brief   Flat profile from the monitor's PC-sampling histogram.
+ * @details Sends 'P' 'D', receives the histogram and adds each bucket to
+ *          the function of the linker map that holds the bucket's first
+ *          address. With buckets wider than one byte, a bucket that
+ *          straddles two functions is counted for the first one.
+ *
+ *          Usage: prof_view [-i baud] [-b baud] [-m exec.map] [-o raw] <port>
+ *                 prof_view [-m exec.map] -f raw
+ *
+ *          Without -m the busiest buckets are listed by address.
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "serial.h"
+#include "symmap.h"
+
+// Download format, see profile_download() in Single_Step_Keil_Compiler/cone.c
+#define PROFILE_DUMP_SYNC (0x5B)
+#define PROFILE_HEADER (13)
+#define PROFILE_BUCKETS_MAX (1024)
+#define PROFILE_SIZE (PROFILE_HEADER + 2 * PROFILE_BUCKETS_MAX)
+#define PROFILE_TIMEOUT_MS (2000)
+#define QUIET_MS (300)
+#define TOP_BUCKETS (20)
+
+typedef struct {
+    unsigned base;
+    unsigned shift;
+    unsigned buckets;
+    unsigned long total;
+    unsigned long outside;
+    unsigned long count[PROFILE_BUCKETS_MAX];
+} profile_t;
+
+typedef struct {
+    const char *name;
+    unsigned address;
+    unsigned long samples;
+} entry_t;
+
+
+static void usage(void);
+static int receive_profile(int fd, uint8_t *raw);
+static int parse_profile(const uint8_t *raw, profile_t *profile);
+static int compare_entries(const void *a, const void *b);
+static void print_by_function(const profile_t *profile, const symmap_t *map);
+static void print_by_bucket(const profile_t *profile);
+
+
+static void usage(void) {
+    fprintf(stderr, "usage: prof_view [-i baud] [-b baud] [-m exec.map] [-o raw] <port>\n"
+                    "       prof_view [-m exec.map] -f raw\n");
+    exit(2);
+}
+
+static int receive_profile(int fd, uint8_t *raw) {
+    unsigned sum = 0;
+    int c, hi, lo;
+
+    if (serial_write(fd, "PD", 2) < 0)
+        return -1;
+    do {
+        c = serial_read_byte(fd, PROFILE_TIMEOUT_MS);
+        if (c < 0) {
+            fprintf(stderr, "prof_view: no profile from the monitor\n");
+            return -1;
+        }
+    } while (c != PROFILE_DUMP_SYNC);
+
+    for (int i = 0; i < PROFILE_SIZE; i++) {
+        c = serial_read_byte(fd, PROFILE_TIMEOUT_MS);
+        if (c < 0) {
+            fprintf(stderr, "prof_view: timeout at byte %d\n", i);
+            return -1;
+        }
+        raw[i] = (uint8_t)c;
+        sum += (unsigned)c;
+    }
+    hi = serial_read_byte(fd, PROFILE_TIMEOUT_MS);
+    lo = serial_read_byte(fd, PROFILE_TIMEOUT_MS);
+    if (hi < 0 || lo < 0 || (uint16_t)sum != (uint16_t)((hi << 8) | lo)) {
+        fprintf(stderr, "prof_view: checksum mismatch\n");
+        return -1;
+    }
+    return 0;
+}
+
+static int parse_profile(const uint8_t *raw, profile_t *profile) {
+    profile->base = (raw[0] << 8) | raw[1];
+    profile->shift = raw[2];
+    profile->buckets = (raw[3] << 8) | raw[4];
+    profile->total = ((unsigned long)raw[5] << 24) | ((unsigned long)raw[6] << 16) |
+                     ((unsigned long)raw[7] << 8) | raw[8];
+    profile->outside = ((unsigned long)raw[9] << 24) | ((unsigned long)raw[10] << 16) |
+                       ((unsigned long)raw[11] << 8) | raw[12];
+    if (profile->buckets > PROFILE_BUCKETS_MAX || profile->shift > 15) {
+        fprintf(stderr, "prof_view: bad profile header\n");
+        return -1;
+    }
+    for (unsigned i = 0; i < profile->buckets; i++)
+        profile->count[i] = (raw[PROFILE_HEADER + 2 * i] << 8) | raw[PROFILE_HEADER + 2 * i + 1];
+    return 0;
+}
+
+static int compare_entries(const void *a, const void *b) {
+    const entry_t *x = a, *y = b;
+
+    if (x->samples != y->samples)
+        return x->samples < y->samples ? 1 : -1;
+    return x->address < y->address ? -1 : (x->address > y->address);
+}
+
+static void print_by_function(const profile_t *profile, const symmap_t *map) {
+    entry_t *entries = calloc(map->count + 1, sizeof(entry_t));
+    size_t used = 0;
+
+    if (!entries) {
+        perror("prof_view");
+        exit(1);
+    }
+    for (size_t i = 0; i < map->count; i++) {
+        entries[i].name = map->symbols[i].name;
+        entries[i].address = map->symbols[i].address;
+    }
+    entries[map->count].name = "(below first symbol)";
+
+    for (unsigned b = 0; b < profile->buckets; b++) {
+        unsigned address = profile->base + (b << profile->shift);
+        long s;
+
+        if (!profile->count[b])
+            continue;
+        s = symmap_find(map, address);
+        entries[s < 0 ? (long)map->count : s].samples += profile->count[b];
+    }
+
+    qsort(entries, map->count + 1, sizeof(entry_t), compare_entries);
+    printf("  samples      %%  address  function\n");
+    for (size_t i = 0; i <= map->count && entries[i].samples; i++, used++) {
+        printf("%9lu %6.2f  %04X     %s\n", entries[i].samples,
+               100.0 * entries[i].samples / profile->total, entries[i].address, entries[i].name);
+    }
+    if (!used)
+        printf("  (no samples inside the histogram)\n");
+    free(entries);
+}
+
+static void print_by_bucket(const profile_t *profile) {
+    entry_t entries[PROFILE_BUCKETS_MAX];
+
+    for (unsigned b = 0; b < profile->buckets; b++) {
+        entries[b].name = "";
+        entries[b].address = profile->base + (b << profile->shift);
+        entries[b].samples = profile->count[b];
+    }
+    qsort(entries, profile->buckets, sizeof(entry_t), compare_entries);
+    printf("  samples      %%  address\n");
+    for (unsigned i = 0; i < profile->buckets && i < TOP_BUCKETS && entries[i].samples; i++) {
+        printf("%9lu %6.2f  %04X-%04X\n", entries[i].samples,
+               100.0 * entries[i].samples / profile->total, entries[i].address,
+               entries[i].address + (1u << profile->shift) - 1);
+    }
+}
+
+int main(int argc, char **argv) {
+    long initial_baud = SERIAL_DEFAULT_BAUD;
+    long baud = 0;
+    const char *map_path = NULL, *raw_out = NULL, *raw_in = NULL;
+    uint8_t raw[PROFILE_SIZE];
+    static profile_t profile;
+    symmap_t map;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "i:b:m:o:f:")) != -1) {
+        if (opt == 'i')
+            initial_baud = strtol(optarg, NULL, 10);
+        else if (opt == 'b')
+            baud = strtol(optarg, NULL, 10);
+        else if (opt == 'm')
+            map_path = optarg;
+        else if (opt == 'o')
+            raw_out = optarg;
+        else if (opt == 'f')
+            raw_in = optarg;
+        else
+            usage();
+    }
+
+    if (raw_in) {
+        FILE *in = fopen(raw_in, "rb");
+
+        if (argc != optind)
+            usage();
+        if (!in || fread(raw, 1, sizeof(raw), in) != sizeof(raw)) {
+            fprintf(stderr, "prof_view: cannot read %s\n", raw_in);
+            return 1;
+        }
+        fclose(in);
+    } else {
+        int fd;
+
+        if (argc - optind != 1)
+            usage();
+        fd = serial_open(argv[optind], initial_baud);
+        if (fd < 0)
+            return 1;
+        if (baud && serial_negotiate_baud(fd, initial_baud, baud) < 0)
+            return 1;
+        serial_drain(fd, QUIET_MS);
+        if (receive_profile(fd, raw) < 0)
+            return 1;
+        serial_drain(fd, QUIET_MS);
+        close(fd);
+        if (raw_out) {
+            FILE *out = fopen(raw_out, "wb");
+
+            if (!out || fwrite(raw, 1, sizeof(raw), out) != sizeof(raw)) {
+                perror(raw_out);
+                return 1;
+            }
+            fclose(out);
+        }
+    }
+
+    if (parse_profile(raw, &profile) < 0)
+        return 1;
+    printf("%lu samples, %lu outside %04X-%04X, %u-byte buckets\n", profile.total,
+           profile.outside, profile.base,
+           (profile.base + (profile.buckets << profile.shift) - 1) & 0xFFFF, 1u << profile.shift);
+    if (profile.total == 0)
+        return 0;
+
+    if (map_path) {
+        if (symmap_load(map_path, &map) < 0)
+            return 1;
+        print_by_function(&profile, &map);
+        symmap_free(&map);
+    } else {
+        print_by_bucket(&profile);
+    }
+    return 0;
+}
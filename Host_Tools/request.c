@@ -0,0 +1,94 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    request.c
+ * @brief   Encodes requests and decodes replies of the pipelined protocol.
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+#include <string.h>
+#include "crc.h"
+#include "request.h"
+#include "serial.h"
+
+
+int request_send(int fd, uint8_t seq, uint8_t op, const uint8_t *payload, uint8_t len) {
+    uint8_t buffer[4 + REQUEST_PAYLOAD_MAX + 2];
+    uint16_t crc;
+
+    buffer[0] = FRAME_SYNC;
+    buffer[1] = seq;
+    buffer[2] = op;
+    buffer[3] = len;
+    if (len)
+        memcpy(buffer + 4, payload, len);
+    crc = crc16_ccitt(CRC16_INIT, buffer + 1, 3 + len);
+    buffer[4 + len] = (uint8_t)(crc >> 8);
+    buffer[5 + len] = (uint8_t)crc;
+    return serial_write(fd, buffer, 6 + len);
+}
+
+frame_status_t reply_receive(int fd, reply_t *reply) {
+    uint8_t header[3];
+    int c;
+    int hi, lo;
+    uint16_t crc;
+
+    // Skip command echo and prompt text until the sync byte
+    do {
+        c = serial_read_byte(fd, FRAME_TIMEOUT_MS);
+        if (c < 0)
+            return FRAME_TIMEOUT;
+    } while (c != FRAME_SYNC);
+
+    for (int i = 0; i < 3; i++) {
+        c = serial_read_byte(fd, FRAME_TIMEOUT_MS);
+        if (c < 0)
+            return FRAME_TIMEOUT;
+        header[i] = (uint8_t)c;
+    }
+    reply->seq = header[0];
+    reply->type = header[1];
+    reply->len = header[2];
+    if (reply->len > FRAME_PAYLOAD_MAX)
+        return FRAME_BAD_LENGTH;
+
+    for (int i = 0; i < reply->len; i++) {
+        c = serial_read_byte(fd, FRAME_TIMEOUT_MS);
+        if (c < 0)
+            return FRAME_TIMEOUT;
+        reply->payload[i] = (uint8_t)c;
+    }
+
+    hi = serial_read_byte(fd, FRAME_TIMEOUT_MS);
+    lo = serial_read_byte(fd, FRAME_TIMEOUT_MS);
+    if (hi < 0 || lo < 0)
+        return FRAME_TIMEOUT;
+
+    crc = crc16_ccitt(CRC16_INIT, header, 3);
+    crc = crc16_ccitt(crc, reply->payload, reply->len);
+    if (crc != (uint16_t)((hi << 8) | lo))
+        return FRAME_BAD_CRC;
+    return FRAME_OK;
+}
+
+const char *request_status_name(uint8_t status) {
+    switch (status) {
+        case REQUEST_OK:         return "ok";
+        case REQUEST_BAD_CRC:    return "request CRC mismatch";
+        case REQUEST_BAD_FORMAT: return "malformed request";
+        case REQUEST_BAD_RANGE:  return "invalid range";
+        default:                 return "unknown status";
+    }
+}
@@ -0,0 +1,82 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    request.h
+ * @brief   Header file for the host side of the pipelined request protocol.
+ * @details Layout (see Memory_Interpretation_SDCC/src/request.h):
+ *          requests are 0x7E, seq, op, len, payload[len], crc16 (hi, lo)
+ *          and replies 0x7E, seq, type, len, payload[len], crc16 (hi, lo).
+ *          The CRC is CRC-16/CCITT-FALSE over every byte after the sync.
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+
+#ifndef _request_H_
+#define _request_H_
+
+#include <stdint.h>
+#include "frame.h"
+
+#define REQUEST_VERSION (1)
+#define REQUEST_WRITE_MAX (32)
+#define REQUEST_PAYLOAD_MAX (2 + REQUEST_WRITE_MAX)
+
+#define REQUEST_READ ('R')
+#define REQUEST_WRITE ('W')
+#define REQUEST_CRC ('K')
+#define REQUEST_QUIT ('Q')
+
+#define REPLY_HELLO ('H')
+#define REPLY_DATA ('D')
+#define REPLY_END ('E')
+
+#define REQUEST_OK (0)
+#define REQUEST_BAD_CRC (1)
+#define REQUEST_BAD_FORMAT (2)
+#define REQUEST_BAD_RANGE (3)
+
+typedef struct {
+    uint8_t seq;
+    uint8_t type;
+    uint8_t len;
+    uint8_t payload[FRAME_PAYLOAD_MAX];
+} reply_t;
+
+/**
+ * @brief   Sends one request.
+ * @param   fd - Serial port file descriptor.
+ * @param   seq - Sequence number echoed in the replies.
+ * @param   op - REQUEST_READ, REQUEST_WRITE, REQUEST_CRC or REQUEST_QUIT.
+ * @param   payload - Request arguments.
+ * @param   len - Payload length, at most REQUEST_PAYLOAD_MAX.
+ * @return  0 on success, -1 on error.
+ */
+int request_send(int fd, uint8_t seq, uint8_t op, const uint8_t *payload, uint8_t len);
+
+/**
+ * @brief   Waits for the next reply frame and validates it.
+ * @param   fd - Serial port file descriptor.
+ * @param   reply - Receives the decoded frame.
+ * @return  FRAME_OK or the reason the frame was rejected.
+ */
+frame_status_t reply_receive(int fd, reply_t *reply);
+
+/**
+ * @brief   Returns a short description of a reply status byte.
+ * @param   status - First payload byte of an REPLY_END frame.
+ * @return  Static string.
+ */
+const char *request_status_name(uint8_t status);
+
+#endif
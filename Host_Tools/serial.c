@@ -0,0 +1,182 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    serial.c
+ * @brief   Implements host-side serial port access with termios.
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include "serial.h"
+
+
+#define BAUD_ACK_TIMEOUT_MS (2000)
+#define BAUD_SETTLE_US (100000)
+
+static const long baud_rates[] = { 9600, 19200, 38400, 57600, 115200 };
+
+static speed_t baud_to_speed(long baud);
+
+
+static speed_t baud_to_speed(long baud) {
+    switch (baud) {
+        case 9600:   return B9600;
+        case 19200:  return B19200;
+        case 38400:  return B38400;
+        case 57600:  return B57600;
+        case 115200: return B115200;
+        default:     return 0;
+    }
+}
+
+int serial_open(const char *path, long baud) {
+    int fd = open(path, O_RDWR | O_NOCTTY);
+
+    if (fd < 0) {
+        fprintf(stderr, "serial: cannot open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    if (serial_set_baud(fd, baud) < 0) {
+        close(fd);
+        return -1;
+    }
+    tcflush(fd, TCIOFLUSH);
+    return fd;
+}
+
+int serial_set_baud(int fd, long baud) {
+    struct termios tio;
+    speed_t speed = baud_to_speed(baud);
+
+    if (!speed) {
+        fprintf(stderr, "serial: unsupported baud rate %ld\n", baud);
+        return -1;
+    }
+    if (tcgetattr(fd, &tio) < 0) {
+        fprintf(stderr, "serial: tcgetattr: %s\n", strerror(errno));
+        return -1;
+    }
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cflag &= ~(CSTOPB | CRTSCTS);
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 0;
+    cfsetispeed(&tio, speed);
+    cfsetospeed(&tio, speed);
+    if (tcsetattr(fd, TCSADRAIN, &tio) < 0) {
+        fprintf(stderr, "serial: tcsetattr: %s\n", strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+int serial_write(int fd, const void *data, size_t len) {
+    const unsigned char *p = data;
+
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            fprintf(stderr, "serial: write: %s\n", strerror(errno));
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+int serial_read_byte(int fd, int timeout_ms) {
+    struct pollfd pfd = { .fd = fd, .events = POLLIN };
+    unsigned char c;
+
+    for (;;) {
+        int r = poll(&pfd, 1, timeout_ms);
+        if (r < 0 && errno == EINTR)
+            continue;
+        if (r <= 0)
+            return -1;
+        r = (int)read(fd, &c, 1);
+        if (r == 1)
+            return c;
+        if (r < 0 && errno == EINTR)
+            continue;
+        return -1;
+    }
+}
+
+void serial_drain(int fd, int quiet_ms) {
+    while (serial_read_byte(fd, quiet_ms) >= 0);
+}
+
+int serial_expect(int fd, const char *text, int timeout_ms) {
+    size_t matched = 0, length = strlen(text);
+
+    while (matched < length) {
+        int c = serial_read_byte(fd, timeout_ms);
+        if (c < 0)
+            return -1;
+        if (c == (unsigned char)text[matched])
+            matched++;
+        else
+            matched = (c == (unsigned char)text[0]) ? 1 : 0;
+    }
+    return 0;
+}
+
+int serial_negotiate_baud(int fd, long current, long baud) {
+    char request[2] = { 'U', 0 };
+    char ok[16];
+
+    if (baud == current)
+        return 0;
+    for (size_t i = 0; i < sizeof(baud_rates) / sizeof(baud_rates[0]); i++) {
+        if (baud_rates[i] == baud)
+            request[1] = (char)('1' + i);
+    }
+    if (!request[1]) {
+        fprintf(stderr, "serial: unsupported baud rate %ld\n", baud);
+        return -1;
+    }
+
+    if (serial_write(fd, request, sizeof(request)) < 0 ||
+        serial_expect(fd, "ACK ", BAUD_ACK_TIMEOUT_MS) < 0 ||
+        serial_expect(fd, "\r\n", BAUD_ACK_TIMEOUT_MS) < 0) {
+        fprintf(stderr, "serial: target did not acknowledge %ld baud\n", baud);
+        return -1;
+    }
+
+    // The target switches as soon as the ACK line is out
+    tcdrain(fd);
+    if (serial_set_baud(fd, baud) < 0)
+        return -1;
+    usleep(BAUD_SETTLE_US);
+    tcflush(fd, TCIFLUSH);
+
+    snprintf(ok, sizeof(ok), "OK %ld", baud);
+    if (serial_write(fd, "Y", 1) < 0 || serial_expect(fd, ok, BAUD_ACK_TIMEOUT_MS) < 0) {
+        fprintf(stderr, "serial: no confirmation at %ld baud, staying at %ld\n", baud, current);
+        serial_set_baud(fd, current);
+        return -1;
+    }
+    serial_drain(fd, 200);
+    return 0;
+}
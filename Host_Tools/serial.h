@@ -0,0 +1,93 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    serial.h
+ * @brief   Header file for host-side serial port access.
+ * @details Opens the Bluetooth SPP tty (e.g. /dev/rfcomm0) in raw 8N1 mode
+ *          and provides byte I/O with timeouts for the host tools.
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+
+#ifndef _serial_H_
+#define _serial_H_
+
+#include <stddef.h>
+
+#define SERIAL_DEFAULT_BAUD (9600)
+
+/**
+ * @brief   Opens a serial port in raw mode at the given baud rate.
+ * @param   path - Device path of the port.
+ * @param   baud - Baud rate (9600, 19200, 38400, 57600 or 115200).
+ * @return  File descriptor, or -1 on error (message already printed).
+ */
+int serial_open(const char *path, long baud);
+
+/**
+ * @brief   Changes the baud rate of an open port.
+ * @param   fd - Port file descriptor.
+ * @param   baud - New baud rate.
+ * @return  0 on success, -1 on error.
+ */
+int serial_set_baud(int fd, long baud);
+
+/**
+ * @brief   Moves the target and the port to a new baud rate.
+ * @details Runs the 'U' handshake of the memory editor and the monitor:
+ *          the target acknowledges at the current rate, both sides switch,
+ *          and the host confirms with 'Y' at the new rate. On failure the
+ *          port is put back to the current rate.
+ * @param   fd - Port file descriptor, open at the target's current rate.
+ * @param   current - The rate the link runs at now.
+ * @param   baud - The rate to switch to.
+ * @return  0 on success, -1 on error.
+ */
+int serial_negotiate_baud(int fd, long current, long baud);
+
+/**
+ * @brief   Waits until a given string has been received.
+ * @param   fd - Port file descriptor.
+ * @param   text - String to look for.
+ * @param   timeout_ms - Maximum idle time between bytes.
+ * @return  0 if found, -1 on timeout.
+ */
+int serial_expect(int fd, const char *text, int timeout_ms);
+
+/**
+ * @brief   Writes a buffer to the port.
+ * @param   fd - Port file descriptor.
+ * @param   data - Bytes to send.
+ * @param   len - Number of bytes.
+ * @return  0 on success, -1 on error.
+ */
+int serial_write(int fd, const void *data, size_t len);
+
+/**
+ * @brief   Reads one byte, waiting at most timeout_ms.
+ * @param   fd - Port file descriptor.
+ * @param   timeout_ms - Timeout in milliseconds.
+ * @return  The byte (0-255), or -1 on timeout or error.
+ */
+int serial_read_byte(int fd, int timeout_ms);
+
+/**
+ * @brief   Discards input until the line has been quiet for quiet_ms.
+ * @param   fd - Port file descriptor.
+ * @param   quiet_ms - Required idle time in milliseconds.
+ * @return  None
+ */
+void serial_drain(int fd, int quiet_ms);
+
+#endif
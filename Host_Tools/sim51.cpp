@@ -0,0 +1,210 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    sim51.cpp
+ * @brief   Runs the firmware images on the simulated board.
+ * @details Loads one or more .hex files into code memory, resets the CPU
+ *          and connects its UART to a pseudo terminal, so every host tool
+ *          (bt_dump, step_view, ...) and a terminal program can talk to it
+ *          as if it were /dev/rfcomm0.
+ *
+ *          Usage: sim51 [-g] [-x] [-r] [-s] [-p pc] [-v base] [-c cycles] <hex>...
+ *
+ *          -g holds INT1 (P3.3) low like the single-step jumper, -x makes
+ *          UART bytes take no time, -r slows the CPU to the real 11.0592
+ *          MHz, -s uses stdin/stdout instead of a pty, -p starts at
+ *          another address than 0, -v moves the interrupt vectors
+ *          (-p 2000 -v 2000 runs the memory editor without the monitor)
+ *          and -c stops after that many machine cycles.
+ *          The run statistics go to stderr on exit.
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include "sim8051.h"
+
+// Cycles run between two looks at the terminal (about 4 ms of board time)
+#define SLICE_CYCLES (4096)
+#define IDLE_POLL_MS (50)
+#define MACHINE_CYCLES_PER_SECOND (SIM_FOSC / 12)
+
+static volatile sig_atomic_t stop_requested;
+
+
+static void usage(void);
+static void on_signal(int sig);
+static int open_pty(int *slave);
+static double now_seconds(void);
+static void pace(const Sim8051 &sim, double start);
+
+
+static void usage(void) {
+    fprintf(stderr, "usage: sim51 [-g] [-x] [-r] [-s] [-p pc] [-v base] [-c cycles] <hex>...\n");
+    exit(2);
+}
+
+static void on_signal(int) {
+    stop_requested = 1;
+}
+
+/*
+ * The slave side stays open here as well, so the master does not report
+ * a hang-up every time a client closes the port.
+ */
+static int open_pty(int *slave) {
+    struct termios tio;
+    int fd = posix_openpt(O_RDWR | O_NOCTTY);
+
+    if (fd < 0 || grantpt(fd) < 0 || unlockpt(fd) < 0) {
+        perror("sim51: pty");
+        return -1;
+    }
+    *slave = open(ptsname(fd), O_RDWR | O_NOCTTY);
+    if (*slave < 0) {
+        perror(ptsname(fd));
+        return -1;
+    }
+    tcgetattr(*slave, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(*slave, TCSANOW, &tio);
+    fprintf(stderr, "sim51: UART on %s\n", ptsname(fd));
+    return fd;
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Sleeps while the simulated clock is ahead of the wall clock
+static void pace(const Sim8051 &sim, double start) {
+    double ahead = (double)sim.cycles() / MACHINE_CYCLES_PER_SECOND - (now_seconds() - start);
+
+    if (ahead > 0.001) {
+        struct timespec ts;
+
+        ts.tv_sec = (time_t)ahead;
+        ts.tv_nsec = (long)((ahead - ts.tv_sec) * 1e9);
+        nanosleep(&ts, NULL);
+    }
+}
+
+int main(int argc, char **argv) {
+    static Sim8051 sim;
+    bool real_time = false, use_stdio = false, input_open = true;
+    unsigned long start_pc = 0;
+    uint64_t cycle_limit = 0;
+    int in_fd, out_fd, slave = -1;
+    double start, elapsed;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "gxrsp:v:c:")) != -1) {
+        if (opt == 'g')
+            sim.set_int1(true);
+        else if (opt == 'x')
+            sim.set_fast_uart(true);
+        else if (opt == 'r')
+            real_time = true;
+        else if (opt == 's')
+            use_stdio = true;
+        else if (opt == 'p')
+            start_pc = strtoul(optarg, NULL, 16);
+        else if (opt == 'v')
+            sim.set_vector_base((uint16_t)strtoul(optarg, NULL, 16));
+        else if (opt == 'c')
+            cycle_limit = strtoull(optarg, NULL, 10);
+        else
+            usage();
+    }
+    if (optind >= argc)
+        usage();
+    for (int i = optind; i < argc; i++) {
+        if (sim.load_hex(argv[i]) < 0)
+            return 1;
+    }
+    sim.reset();
+    sim.set_pc((uint16_t)start_pc);
+
+    if (use_stdio) {
+        in_fd = STDIN_FILENO;
+        out_fd = STDOUT_FILENO;
+    } else {
+        in_fd = out_fd = open_pty(&slave);
+        if (in_fd < 0)
+            return 1;
+    }
+    fcntl(in_fd, F_SETFL, fcntl(in_fd, F_GETFL) | O_NONBLOCK);
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    start = now_seconds();
+    while (!stop_requested) {
+        uint8_t buffer[256];
+        struct pollfd pfd = { in_fd, POLLIN, 0 };
+        size_t count = 0;
+        uint8_t c;
+        ssize_t n;
+
+        sim.run(SLICE_CYCLES);
+        while (sim.uart_transmit(&c)) {
+            buffer[count++] = c;
+            if (count == sizeof(buffer)) {
+                if (write(out_fd, buffer, count) < 0)
+                    stop_requested = 1;
+                count = 0;
+            }
+        }
+        if (count && write(out_fd, buffer, count) < 0)
+            stop_requested = 1;
+
+        if (cycle_limit && sim.cycles() >= cycle_limit)
+            break;
+        if (sim.idle() && !input_open)
+            break;
+
+        if (input_open && poll(&pfd, 1, sim.idle() ? IDLE_POLL_MS : 0) > 0) {
+            n = read(in_fd, buffer, sizeof(buffer));
+            if (n > 0) {
+                for (ssize_t i = 0; i < n; i++)
+                    sim.uart_receive(buffer[i]);
+            } else if (n == 0 || (errno != EAGAIN && errno != EINTR)) {
+                input_open = false;
+            }
+        }
+        if (real_time)
+            pace(sim, start);
+    }
+    elapsed = now_seconds() - start;
+
+    fprintf(stderr, "sim51: PC %04X, %llu instructions, %llu cycles (%.3f s on the board) in %.3f s,"
+                    " %.1fx real time\n",
+            sim.pc(), (unsigned long long)sim.instructions(), (unsigned long long)sim.cycles(),
+            (double)sim.cycles() / MACHINE_CYCLES_PER_SECOND, elapsed,
+            elapsed > 0 ? (double)sim.cycles() / MACHINE_CYCLES_PER_SECOND / elapsed : 0.0);
+    fprintf(stderr, "sim51: %llu bytes sent, %llu bytes received\n",
+            (unsigned long long)sim.tx_bytes(), (unsigned long long)sim.rx_bytes());
+    if (slave >= 0)
+        close(slave);
+    return 0;
+}
@@ -0,0 +1,1003 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    sim8051.cpp
+ * @brief   Implements the AT89C51ED2 instruction-set simulator.
+ * @details Opcodes are decoded once, when the dispatch table is built: each
+ *          of the 256 entries points at the handler for its instruction
+ *          group, which takes the register or addressing mode from the low
+ *          bits of the opcode. Executing an instruction is one indexed call
+ *          plus a cycle-table lookup, so the core runs about 70 times
+ *          faster than the 921,600 machine cycles per second of the board.
+ *
+ *          The UART holds a received byte until RI is clear instead of
+ *          overrunning, so a host can paste faster than the firmware reads.
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+#include <cstring>
+#include "ihex.h"
+#include "sim8051.h"
+
+// SFR offsets (address - 0x80)
+#define SFR_SP (0x01)
+#define SFR_DPL (0x02)
+#define SFR_DPH (0x03)
+#define SFR_PCON (0x07)
+#define SFR_TCON (0x08)
+#define SFR_TMOD (0x09)
+#define SFR_TL0 (0x0A)
+#define SFR_TH0 (0x0C)
+#define SFR_P0 (0x00)
+#define SFR_P1 (0x10)
+#define SFR_SCON (0x18)
+#define SFR_BRL (0x1A)
+#define SFR_BDRCON (0x1B)
+#define SFR_P2 (0x20)
+#define SFR_AUXR1 (0x22)
+#define SFR_IE (0x28)
+#define SFR_P3 (0x30)
+#define SFR_IPH0 (0x37)
+#define SFR_IP (0x38)
+#define SFR_PSW (0x50)
+#define SFR_CCON (0x58)
+#define SFR_CL (0x69)
+#define SFR_B (0x70)
+#define SFR_CH (0x79)
+
+#define ADDRESS_SBUF (0x99)
+#define ADDRESS_AUXR1 (0xA2)
+#define ADDRESS_IE (0xA8)
+#define ADDRESS_P3 (0xB0)
+#define ADDRESS_IPH0 (0xB7)
+#define ADDRESS_IP (0xB8)
+
+#define PSW_CY (0x80)
+#define PSW_AC (0x40)
+#define PSW_OV (0x04)
+#define PSW_P (0x01)
+
+#define TCON_TF1 (0x80)
+#define TCON_TR1 (0x40)
+#define TCON_TF0 (0x20)
+#define TCON_TR0 (0x10)
+#define TCON_IE1 (0x08)
+#define TCON_IT1 (0x04)
+#define TCON_IE0 (0x02)
+#define TCON_IT0 (0x01)
+
+#define SCON_REN (0x10)
+#define SCON_TI (0x02)
+#define SCON_RI (0x01)
+
+#define BDRCON_BRR (0x10)
+#define BDRCON_TBCK (0x08)
+#define BDRCON_SPD (0x02)
+#define PCON_SMOD1 (0x80)
+#define CCON_CF (0x80)
+#define CCON_CR (0x40)
+#define IE_EA (0x80)
+#define P3_INT1 (0x08)
+#define BIT_RI (0x98)
+
+#define INTERRUPT_SOURCES (5)
+#define VECTOR_CYCLES (2)
+
+static const uint8_t interrupt_vectors[INTERRUPT_SOURCES] = { 0x03, 0x0B, 0x13, 0x1B, 0x23 };
+
+Sim8051::Handler Sim8051::dispatch_[256];
+
+// Machine cycles per opcode, from the instruction set table of the data sheet
+const uint8_t Sim8051::cycle_table_[256] = {
+    1, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,     // 0x00
+    2, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,     // 0x10
+    2, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,     // 0x20
+    2, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,     // 0x30
+    2, 2, 1, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,     // 0x40
+    2, 2, 1, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,     // 0x50
+    2, 2, 1, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,     // 0x60
+    2, 2, 2, 2, 1, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,     // 0x70
+    2, 2, 2, 2, 4, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,     // 0x80
+    2, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,     // 0x90
+    2, 2, 1, 2, 4, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,     // 0xA0
+    2, 2, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,     // 0xB0
+    2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,     // 0xC0
+    2, 2, 1, 1, 1, 2, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2,     // 0xD0
+    2, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,     // 0xE0
+    2, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1      // 0xF0
+};
+
+
+void Sim8051::build_dispatch() {
+    for (unsigned op = 0; op < 256; op++) {
+        unsigned low = op & 0x0F, high = op >> 4;
+        Handler h = &Sim8051::op_reserved;
+
+        if (low == 0x01) {
+            h = (high & 1) ? &Sim8051::op_acall : &Sim8051::op_ajmp;
+        } else if (low >= 0x04) {
+            // Columns 4-F: A or #data, direct, @R0-@R1, R0-R7
+            switch (high) {
+            case 0x0: h = &Sim8051::op_inc; break;
+            case 0x1: h = &Sim8051::op_dec; break;
+            case 0x2: case 0x3: h = &Sim8051::op_add; break;
+            case 0x4: case 0x5: case 0x6: h = &Sim8051::op_logic_a; break;
+            case 0x7: h = &Sim8051::op_mov_immediate; break;
+            case 0x8: h = (low == 0x05) ? &Sim8051::op_mov_direct_direct : &Sim8051::op_mov_to_direct; break;
+            case 0x9: h = &Sim8051::op_subb; break;
+            case 0xA: h = &Sim8051::op_mov_from_direct; break;
+            case 0xB: h = &Sim8051::op_cjne; break;
+            case 0xC: h = &Sim8051::op_xch; break;
+            case 0xD: h = (low == 0x06 || low == 0x07) ? &Sim8051::op_xchd : &Sim8051::op_djnz; break;
+            case 0xE: h = &Sim8051::op_mov_a; break;
+            case 0xF: h = &Sim8051::op_mov_from_a; break;
+            }
+        }
+        dispatch_[op] = h;
+    }
+
+    // Columns 0, 2 and 3, plus the exceptions in columns 4 and 5
+    dispatch_[0x00] = &Sim8051::op_nop;
+    dispatch_[0x02] = &Sim8051::op_ljmp;
+    dispatch_[0x03] = dispatch_[0x13] = dispatch_[0x23] = dispatch_[0x33] = &Sim8051::op_rotate;
+    dispatch_[0x10] = dispatch_[0x20] = dispatch_[0x30] = &Sim8051::op_jbit;
+    dispatch_[0x12] = &Sim8051::op_lcall;
+    dispatch_[0x22] = &Sim8051::op_ret;
+    dispatch_[0x32] = &Sim8051::op_reti;
+    dispatch_[0x40] = dispatch_[0x50] = &Sim8051::op_jcarry;
+    dispatch_[0x60] = dispatch_[0x70] = &Sim8051::op_jzero;
+    dispatch_[0x42] = dispatch_[0x43] = &Sim8051::op_logic_direct;
+    dispatch_[0x52] = dispatch_[0x53] = &Sim8051::op_logic_direct;
+    dispatch_[0x62] = dispatch_[0x63] = &Sim8051::op_logic_direct;
+    dispatch_[0x72] = dispatch_[0x82] = dispatch_[0xA0] = dispatch_[0xB0] = &Sim8051::op_logic_carry;
+    dispatch_[0x73] = &Sim8051::op_jmp_dptr;
+    dispatch_[0x80] = &Sim8051::op_sjmp;
+    dispatch_[0x83] = dispatch_[0x93] = &Sim8051::op_movc;
+    dispatch_[0x84] = &Sim8051::op_div;
+    dispatch_[0x90] = &Sim8051::op_mov_dptr;
+    dispatch_[0x92] = &Sim8051::op_mov_bit_c;
+    dispatch_[0xA2] = &Sim8051::op_mov_c_bit;
+    dispatch_[0xA3] = &Sim8051::op_inc_dptr;
+    dispatch_[0xA4] = &Sim8051::op_mul;
+    dispatch_[0xA5] = &Sim8051::op_reserved;
+    dispatch_[0xB2] = dispatch_[0xB3] = dispatch_[0xC2] = dispatch_[0xC3] = &Sim8051::op_bit;
+    dispatch_[0xD2] = dispatch_[0xD3] = &Sim8051::op_bit;
+    dispatch_[0xC0] = &Sim8051::op_push;
+    dispatch_[0xC4] = &Sim8051::op_swap;
+    dispatch_[0xD0] = &Sim8051::op_pop;
+    dispatch_[0xD4] = &Sim8051::op_da;
+    dispatch_[0xE0] = dispatch_[0xE2] = dispatch_[0xE3] = &Sim8051::op_movx_read;
+    dispatch_[0xE4] = &Sim8051::op_clr_a;
+    dispatch_[0xF0] = dispatch_[0xF2] = dispatch_[0xF3] = &Sim8051::op_movx_write;
+    dispatch_[0xF4] = &Sim8051::op_cpl_a;
+}
+
+Sim8051::Sim8051() {
+    if (!dispatch_[0])
+        build_dispatch();
+    memset(code_, 0xFF, sizeof(code_));
+    memset(xram_, 0, sizeof(xram_));
+    fast_uart_ = false;
+    int1_low_ = false;
+    vector_base_ = 0;
+    reset();
+}
+
+void Sim8051::reset() {
+    memset(iram_, 0, sizeof(iram_));
+    memset(sfr_, 0, sizeof(sfr_));
+    sfr_[SFR_SP] = 0x07;
+    sfr_[SFR_P0] = sfr_[SFR_P1] = sfr_[SFR_P2] = sfr_[SFR_P3] = 0xFF;
+    pc_ = 0;
+    cycles_ = 0;
+    instructions_ = 0;
+    other_dpl_ = other_dph_ = 0;
+    in_service_ = 0;
+    interrupt_hold_ = false;
+    int1_last_ = int1_low_;
+    idle_ = false;
+    sbuf_rx_ = 0;
+    tx_busy_ = rx_busy_ = false;
+    tx_shift_ = 0;
+    tx_done_ = rx_done_ = 0;
+    tx_count_ = rx_count_ = 0;
+    rx_line_.clear();
+    tx_line_.clear();
+}
+
+int Sim8051::load_hex(const char *path) {
+    static uint8_t image[IHEX_IMAGE_SIZE];
+    unsigned low, high;
+
+    if (ihex_load(path, image, &low, &high) < 0)
+        return -1;
+    for (unsigned a = low; a <= high && a < IHEX_IMAGE_SIZE; a++) {
+        if (image[a] != 0xFF)
+            code_[a] = image[a];
+    }
+    return 0;
+}
+
+uint8_t Sim8051::xram(uint16_t address) const {
+    return read_xram(address);
+}
+
+uint8_t Sim8051::read_xram(uint16_t address) const {
+    return (address < SIM_XRAM_SIZE) ? xram_[address] : 0xFF;
+}
+
+void Sim8051::write_xram(uint16_t address, uint8_t value) {
+    if (address < SIM_XRAM_SIZE)
+        xram_[address] = value;
+}
+
+void Sim8051::uart_receive(uint8_t c) {
+    rx_line_.push_back(c);
+}
+
+bool Sim8051::uart_transmit(uint8_t *c) {
+    if (tx_line_.empty())
+        return false;
+    *c = tx_line_.front();
+    tx_line_.pop_front();
+    return true;
+}
+
+/*
+ * Plain reads of P3 see the pins, so INT1 reads low while it is grounded;
+ * read-modify-write instructions pass pins = false and get the latch.
+ */
+uint8_t Sim8051::read_direct(uint8_t address, bool pins) {
+    if (address < 0x80)
+        return iram_[address];
+    if (address == ADDRESS_SBUF)
+        return sbuf_rx_;
+    if (address == ADDRESS_P3 && pins && int1_low_)
+        return sfr_[SFR_P3] & (uint8_t)~P3_INT1;
+    return sfr_[address & 0x7F];
+}
+
+void Sim8051::write_direct(uint8_t address, uint8_t value) {
+    if (address < 0x80) {
+        iram_[address] = value;
+        return;
+    }
+    switch (address) {
+    case ADDRESS_SBUF:
+        tx_shift_ = value;
+        tx_busy_ = true;
+        tx_done_ = cycles_ + byte_cycles();
+        return;
+    case ADDRESS_AUXR1:
+        // Bit 2 always reads 0, so INC AUXR1 toggles DPS
+        value &= (uint8_t)~0x04;
+        if ((value ^ sfr_[SFR_AUXR1]) & 0x01) {
+            uint8_t dpl = sfr_[SFR_DPL], dph = sfr_[SFR_DPH];
+
+            sfr_[SFR_DPL] = other_dpl_;
+            sfr_[SFR_DPH] = other_dph_;
+            other_dpl_ = dpl;
+            other_dph_ = dph;
+        }
+        break;
+    case ADDRESS_IE:
+    case ADDRESS_IP:
+    case ADDRESS_IPH0:
+        interrupt_hold_ = true;
+        break;
+    }
+    sfr_[address & 0x7F] = value;
+}
+
+bool Sim8051::read_bit(uint8_t bit, bool pins) {
+    uint8_t byte;
+
+    if (bit < 0x80)
+        byte = iram_[0x20 + (bit >> 3)];
+    else
+        byte = read_direct(bit & 0xF8, pins);
+    return (byte >> (bit & 7)) & 1;
+}
+
+void Sim8051::write_bit(uint8_t bit, bool value) {
+    uint8_t mask = (uint8_t)(1 << (bit & 7));
+
+    if (bit < 0x80) {
+        uint8_t &byte = iram_[0x20 + (bit >> 3)];
+
+        byte = value ? (byte | mask) : (byte & ~mask);
+    } else {
+        uint8_t address = bit & 0xF8;
+        uint8_t byte = read_direct(address);
+
+        write_direct(address, value ? (byte | mask) : (byte & ~mask));
+    }
+}
+
+// Source operand of the column 4-F instructions
+uint8_t Sim8051::read_operand(uint8_t op) {
+    switch (op & 0x0F) {
+    case 0x04: return fetch();
+    case 0x05: return read_direct(fetch(), true);
+    case 0x06: case 0x07: return iram_[ri_address(op)];
+    default: return reg(op & 0x07);
+    }
+}
+
+void Sim8051::set_dptr(uint16_t value) {
+    sfr_[SFR_DPL] = (uint8_t)value;
+    sfr_[SFR_DPH] = (uint8_t)(value >> 8);
+}
+
+void Sim8051::push(uint8_t value) {
+    iram_[++sfr_[SFR_SP]] = value;
+}
+
+uint8_t Sim8051::pop() {
+    return iram_[sfr_[SFR_SP]--];
+}
+
+void Sim8051::set_carry(bool carry) {
+    if (carry)
+        sfr_[SFR_PSW] |= PSW_CY;
+    else
+        sfr_[SFR_PSW] &= (uint8_t)~PSW_CY;
+}
+
+void Sim8051::add(uint8_t value, bool carry_in) {
+    unsigned a = acc(), c = carry_in ? 1 : 0;
+    unsigned result = a + value + c;
+    uint8_t psw = sfr_[SFR_PSW] & (uint8_t)~(PSW_CY | PSW_AC | PSW_OV);
+
+    if (result > 0xFF)
+        psw |= PSW_CY;
+    if ((a & 0x0F) + (value & 0x0F) + c > 0x0F)
+        psw |= PSW_AC;
+    if ((a ^ result) & (value ^ result) & 0x80)
+        psw |= PSW_OV;
+    sfr_[SFR_PSW] = psw;
+    acc() = (uint8_t)result;
+}
+
+void Sim8051::subtract(uint8_t value) {
+    unsigned a = acc(), c = carry() ? 1 : 0;
+    unsigned result = (a - value - c) & 0xFF;
+    uint8_t psw = sfr_[SFR_PSW] & (uint8_t)~(PSW_CY | PSW_AC | PSW_OV);
+
+    if (a < value + c)
+        psw |= PSW_CY;
+    if ((a & 0x0F) < (value & 0x0F) + c)
+        psw |= PSW_AC;
+    if ((a ^ value) & (a ^ result) & 0x80)
+        psw |= PSW_OV;
+    sfr_[SFR_PSW] = psw;
+    acc() = (uint8_t)result;
+}
+
+/*
+ * Machine cycles per UART frame (start, 8 data, stop) at the current rate:
+ * the internal baud rate generator when it clocks the transmitter,
+ * otherwise Timer 1 in mode 2.
+ */
+unsigned Sim8051::byte_cycles() const {
+    unsigned long baud = SIM_UART_DEFAULT_BAUD;
+    unsigned smod = (sfr_[SFR_PCON] & PCON_SMOD1) ? 2 : 1;
+
+    if (fast_uart_)
+        return 1;
+    if ((sfr_[SFR_BDRCON] & (BDRCON_BRR | BDRCON_TBCK)) == (BDRCON_BRR | BDRCON_TBCK)) {
+        baud = smod * (SIM_FOSC / 2) / (32UL * (256 - sfr_[SFR_BRL]));
+        if (!(sfr_[SFR_BDRCON] & BDRCON_SPD))
+            baud /= 6;
+    } else if ((sfr_[SFR_TCON] & TCON_TR1) && ((sfr_[SFR_TMOD] >> 4) & 0x03) == 2) {
+        baud = smod * SIM_FOSC / (384UL * (256 - sfr_[SFR_TH0 + 1]));
+    }
+    if (!baud)
+        baud = 1;
+    return (unsigned)((10 * SIM_FOSC / 12 + baud / 2) / baud);
+}
+
+void Sim8051::tick_timer(unsigned n, unsigned cycles) {
+    unsigned mode = (sfr_[SFR_TMOD] >> (4 * n)) & 0x0F;
+    uint8_t &tl = sfr_[SFR_TL0 + n];
+    uint8_t &th = sfr_[SFR_TH0 + n];
+    uint8_t flag = n ? TCON_TF1 : TCON_TF0;
+    unsigned count;
+
+    // C/T = 1 counts T0/T1 pin edges, and nothing drives those pins
+    if (mode & 0x04)
+        return;
+    switch (mode & 0x03) {
+    case 0:
+        count = ((th << 5) | (tl & 0x1F)) + cycles;
+        if (count > 0x1FFF)
+            sfr_[SFR_TCON] |= flag;
+        th = (uint8_t)(count >> 5);
+        tl = (uint8_t)((tl & 0xE0) | (count & 0x1F));
+        break;
+    case 1:
+        count = ((th << 8) | tl) + cycles;
+        if (count > 0xFFFF)
+            sfr_[SFR_TCON] |= flag;
+        th = (uint8_t)(count >> 8);
+        tl = (uint8_t)count;
+        break;
+    case 2:
+        count = tl + cycles;
+        if (count > 0xFF) {
+            sfr_[SFR_TCON] |= flag;
+            count = th + (count - 0x100) % (0x100 - th);
+        }
+        tl = (uint8_t)count;
+        break;
+    default:
+        break;
+    }
+}
+
+void Sim8051::tick(unsigned cycles) {
+    uint8_t tcon;
+
+    cycles_ += cycles;
+    tcon = sfr_[SFR_TCON];
+    if (tcon & TCON_TR0)
+        tick_timer(0, cycles);
+    if (tcon & TCON_TR1)
+        tick_timer(1, cycles);
+
+    if (sfr_[SFR_CCON] & CCON_CR) {
+        unsigned count = ((sfr_[SFR_CH] << 8) | sfr_[SFR_CL]) + cycles;
+
+        if (count > 0xFFFF)
+            sfr_[SFR_CCON] |= CCON_CF;
+        sfr_[SFR_CH] = (uint8_t)(count >> 8);
+        sfr_[SFR_CL] = (uint8_t)count;
+    }
+
+    if (tx_busy_ && cycles_ >= tx_done_) {
+        tx_busy_ = false;
+        tx_line_.push_back(tx_shift_);
+        tx_count_++;
+        sfr_[SFR_SCON] |= SCON_TI;
+    }
+    if (!rx_busy_ && !rx_line_.empty() && (sfr_[SFR_SCON] & SCON_REN)) {
+        rx_busy_ = true;
+        rx_done_ = cycles_ + byte_cycles();
+    }
+    if (rx_busy_ && cycles_ >= rx_done_ && !(sfr_[SFR_SCON] & SCON_RI)) {
+        rx_busy_ = false;
+        sbuf_rx_ = rx_line_.front();
+        rx_line_.pop_front();
+        rx_count_++;
+        sfr_[SFR_SCON] |= SCON_RI;
+    }
+
+    // INT1: IE1 follows the pin when level triggered, latches a falling edge otherwise
+    if (sfr_[SFR_TCON] & TCON_IT1) {
+        if (int1_low_ && !int1_last_)
+            sfr_[SFR_TCON] |= TCON_IE1;
+    } else if (int1_low_) {
+        sfr_[SFR_TCON] |= TCON_IE1;
+    } else {
+        sfr_[SFR_TCON] &= (uint8_t)~TCON_IE1;
+    }
+    int1_last_ = int1_low_;
+}
+
+/*
+ * Vectors to the highest-priority pending source that outranks every
+ * level in service. Like the hardware, at least one more instruction runs
+ * after RETI or a write to IE/IP before another interrupt is taken, which
+ * is what lets the INT1 handler single-step the user program.
+ */
+unsigned Sim8051::tick_interrupts() {
+    uint8_t ie = sfr_[SFR_IE];
+    uint8_t tcon = sfr_[SFR_TCON];
+    uint8_t pending;
+    int source = -1, level = -1;
+
+    if (interrupt_hold_) {
+        interrupt_hold_ = false;
+        return 0;
+    }
+    if (!(ie & IE_EA))
+        return 0;
+
+    pending = (uint8_t)(((tcon & TCON_IE0) ? 0x01 : 0) | ((tcon & TCON_TF0) ? 0x02 : 0) |
+                        ((tcon & TCON_IE1) ? 0x04 : 0) | ((tcon & TCON_TF1) ? 0x08 : 0) |
+                        ((sfr_[SFR_SCON] & (SCON_RI | SCON_TI)) ? 0x10 : 0)) & ie;
+    if (!pending)
+        return 0;
+
+    for (int n = 0; n < INTERRUPT_SOURCES; n++) {
+        if (pending & (1 << n)) {
+            int l = (((sfr_[SFR_IPH0] >> n) & 1) << 1) | ((sfr_[SFR_IP] >> n) & 1);
+
+            if (l > level) {
+                level = l;
+                source = n;
+            }
+        }
+    }
+    if (in_service_ >> level)
+        return 0;
+
+    if (source == 0 && (tcon & TCON_IT0))
+        sfr_[SFR_TCON] &= (uint8_t)~TCON_IE0;
+    else if (source == 1)
+        sfr_[SFR_TCON] &= (uint8_t)~TCON_TF0;
+    else if (source == 2 && (tcon & TCON_IT1))
+        sfr_[SFR_TCON] &= (uint8_t)~TCON_IE1;
+    else if (source == 3)
+        sfr_[SFR_TCON] &= (uint8_t)~TCON_TF1;
+
+    push((uint8_t)pc_);
+    push((uint8_t)(pc_ >> 8));
+    pc_ = (uint16_t)(vector_base_ + interrupt_vectors[source]);
+    in_service_ |= (uint8_t)(1 << level);
+    return VECTOR_CYCLES;
+}
+
+unsigned Sim8051::step() {
+    uint8_t op;
+    unsigned cycles, vector;
+
+    idle_ = false;
+    op = fetch();
+    (this->*dispatch_[op])(op);
+    instructions_++;
+
+    if (__builtin_parity(acc()))
+        sfr_[SFR_PSW] |= PSW_P;
+    else
+        sfr_[SFR_PSW] &= (uint8_t)~PSW_P;
+
+    cycles = cycle_table_[op];
+    tick(cycles);
+    vector = tick_interrupts();
+    if (vector) {
+        tick(vector);
+        cycles += vector;
+    }
+    return cycles;
+}
+
+void Sim8051::run(uint64_t cycles) {
+    uint64_t end = cycles_ + cycles;
+
+    do {
+        step();
+    } while (cycles_ < end && !idle_);
+}
+
+
+void Sim8051::op_nop(uint8_t) {
+}
+
+void Sim8051::op_reserved(uint8_t) {
+    // 0xA5 is undefined; the board treats it as a one-cycle no-op
+}
+
+void Sim8051::op_ajmp(uint8_t op) {
+    uint8_t low = fetch();
+
+    pc_ = (uint16_t)((pc_ & 0xF800) | ((op & 0xE0) << 3) | low);
+}
+
+void Sim8051::op_acall(uint8_t op) {
+    uint8_t low = fetch();
+
+    push((uint8_t)pc_);
+    push((uint8_t)(pc_ >> 8));
+    pc_ = (uint16_t)((pc_ & 0xF800) | ((op & 0xE0) << 3) | low);
+}
+
+void Sim8051::op_ljmp(uint8_t) {
+    uint8_t high = fetch();
+
+    pc_ = (uint16_t)((high << 8) | fetch());
+}
+
+void Sim8051::op_lcall(uint8_t) {
+    uint8_t high = fetch();
+    uint8_t low = fetch();
+
+    push((uint8_t)pc_);
+    push((uint8_t)(pc_ >> 8));
+    pc_ = (uint16_t)((high << 8) | low);
+}
+
+void Sim8051::op_ret(uint8_t) {
+    uint8_t high = pop();
+
+    pc_ = (uint16_t)((high << 8) | pop());
+}
+
+void Sim8051::op_reti(uint8_t op) {
+    op_ret(op);
+    for (int level = 3; level >= 0; level--) {
+        if (in_service_ & (1 << level)) {
+            in_service_ &= (uint8_t)~(1 << level);
+            break;
+        }
+    }
+    interrupt_hold_ = true;
+}
+
+void Sim8051::op_sjmp(uint8_t) {
+    relative_jump(fetch());
+}
+
+void Sim8051::op_jmp_dptr(uint8_t) {
+    pc_ = (uint16_t)(dptr() + acc());
+}
+
+// JBC, JB, JNB
+void Sim8051::op_jbit(uint8_t op) {
+    uint8_t bit = fetch();
+    uint8_t offset = fetch();
+
+    if (op == 0x10) {
+        if (read_bit(bit, false)) {
+            write_bit(bit, false);
+            relative_jump(offset);
+        }
+    } else if (read_bit(bit) == (op == 0x20)) {
+        relative_jump(offset);
+
+        // JNB RI,$ with nothing on the line and no interrupt that could
+        // change anything: the caller may block until the host sends
+        if (op == 0x30 && bit == BIT_RI && offset == 0xFD && !rx_busy_ && rx_line_.empty() &&
+            !((sfr_[SFR_IE] & IE_EA) && (sfr_[SFR_IE] & 0x7F)))
+            idle_ = true;
+    }
+}
+
+// JC, JNC
+void Sim8051::op_jcarry(uint8_t op) {
+    uint8_t offset = fetch();
+
+    if (carry() == (op == 0x40))
+        relative_jump(offset);
+}
+
+// JZ, JNZ
+void Sim8051::op_jzero(uint8_t op) {
+    uint8_t offset = fetch();
+
+    if ((acc() == 0) == (op == 0x60))
+        relative_jump(offset);
+}
+
+void Sim8051::op_cjne(uint8_t op) {
+    uint8_t left, right, offset;
+
+    switch (op & 0x0F) {
+    case 0x04: left = acc(); right = fetch(); break;
+    case 0x05: left = acc(); right = read_direct(fetch(), true); break;
+    case 0x06: case 0x07: left = iram_[ri_address(op)]; right = fetch(); break;
+    default: left = reg(op & 0x07); right = fetch(); break;
+    }
+    offset = fetch();
+    set_carry(left < right);
+    if (left != right)
+        relative_jump(offset);
+}
+
+void Sim8051::op_djnz(uint8_t op) {
+    uint8_t value, offset;
+
+    if (op == 0xD5) {
+        uint8_t address = fetch();
+
+        value = (uint8_t)(read_direct(address) - 1);
+        write_direct(address, value);
+    } else {
+        value = --reg(op & 0x07);
+    }
+    offset = fetch();
+    if (value)
+        relative_jump(offset);
+}
+
+// RR, RRC, RL, RLC
+void Sim8051::op_rotate(uint8_t op) {
+    uint8_t a = acc();
+
+    switch (op) {
+    case 0x03:
+        acc() = (uint8_t)((a >> 1) | (a << 7));
+        break;
+    case 0x13:
+        acc() = (uint8_t)((a >> 1) | (carry() ? 0x80 : 0));
+        set_carry(a & 0x01);
+        break;
+    case 0x23:
+        acc() = (uint8_t)((a << 1) | (a >> 7));
+        break;
+    default:
+        acc() = (uint8_t)((a << 1) | (carry() ? 0x01 : 0));
+        set_carry(a & 0x80);
+        break;
+    }
+}
+
+void Sim8051::op_inc(uint8_t op) {
+    switch (op & 0x0F) {
+    case 0x04: acc()++; break;
+    case 0x05: {
+        uint8_t address = fetch();
+
+        write_direct(address, (uint8_t)(read_direct(address) + 1));
+        break;
+    }
+    case 0x06: case 0x07: iram_[ri_address(op)]++; break;
+    default: reg(op & 0x07)++; break;
+    }
+}
+
+void Sim8051::op_dec(uint8_t op) {
+    switch (op & 0x0F) {
+    case 0x04: acc()--; break;
+    case 0x05: {
+        uint8_t address = fetch();
+
+        write_direct(address, (uint8_t)(read_direct(address) - 1));
+        break;
+    }
+    case 0x06: case 0x07: iram_[ri_address(op)]--; break;
+    default: reg(op & 0x07)--; break;
+    }
+}
+
+void Sim8051::op_inc_dptr(uint8_t) {
+    set_dptr((uint16_t)(dptr() + 1));
+}
+
+// ADD, ADDC
+void Sim8051::op_add(uint8_t op) {
+    uint8_t value = read_operand(op);
+
+    add(value, (op & 0x10) && carry());
+}
+
+void Sim8051::op_subb(uint8_t op) {
+    subtract(read_operand(op));
+}
+
+// ORL, ANL, XRL with A as destination
+void Sim8051::op_logic_a(uint8_t op) {
+    uint8_t value = read_operand(op);
+
+    switch (op >> 4) {
+    case 0x4: acc() |= value; break;
+    case 0x5: acc() &= value; break;
+    default: acc() ^= value; break;
+    }
+}
+
+// ORL, ANL, XRL with a direct destination (read-modify-write on the latch)
+void Sim8051::op_logic_direct(uint8_t op) {
+    uint8_t address = fetch();
+    uint8_t value = (op & 0x01) ? fetch() : acc();
+    uint8_t target = read_direct(address);
+
+    switch (op >> 4) {
+    case 0x4: target |= value; break;
+    case 0x5: target &= value; break;
+    default: target ^= value; break;
+    }
+    write_direct(address, target);
+}
+
+// ORL C,bit / ANL C,bit / ORL C,/bit / ANL C,/bit
+void Sim8051::op_logic_carry(uint8_t op) {
+    bool value = read_bit(fetch());
+
+    if (op == 0xA0 || op == 0xB0)
+        value = !value;
+    if (op == 0x72 || op == 0xA0)
+        set_carry(carry() || value);
+    else
+        set_carry(carry() && value);
+}
+
+void Sim8051::op_mul(uint8_t) {
+    unsigned product = acc() * sfr_[SFR_B];
+
+    acc() = (uint8_t)product;
+    sfr_[SFR_B] = (uint8_t)(product >> 8);
+    sfr_[SFR_PSW] &= (uint8_t)~(PSW_CY | PSW_OV);
+    if (product > 0xFF)
+        sfr_[SFR_PSW] |= PSW_OV;
+}
+
+void Sim8051::op_div(uint8_t) {
+    uint8_t divisor = sfr_[SFR_B];
+
+    sfr_[SFR_PSW] &= (uint8_t)~(PSW_CY | PSW_OV);
+    if (!divisor) {
+        sfr_[SFR_PSW] |= PSW_OV;
+        return;
+    }
+    sfr_[SFR_B] = acc() % divisor;
+    acc() = acc() / divisor;
+}
+
+void Sim8051::op_da(uint8_t) {
+    unsigned a = acc();
+
+    if ((a & 0x0F) > 9 || (sfr_[SFR_PSW] & PSW_AC))
+        a += 0x06;
+    if ((a & 0x1F0) > 0x90 || carry())
+        a += 0x60;
+    if (a > 0xFF)
+        set_carry(true);
+    acc() = (uint8_t)a;
+}
+
+void Sim8051::op_swap(uint8_t) {
+    acc() = (uint8_t)((acc() << 4) | (acc() >> 4));
+}
+
+void Sim8051::op_clr_a(uint8_t) {
+    acc() = 0;
+}
+
+void Sim8051::op_cpl_a(uint8_t) {
+    acc() = (uint8_t)~acc();
+}
+
+// CPL, CLR, SETB on a bit or on C
+void Sim8051::op_bit(uint8_t op) {
+    if (op & 0x01) {
+        set_carry(op == 0xD3 || (op == 0xB3 && !carry()));
+    } else {
+        uint8_t bit = fetch();
+
+        write_bit(bit, op == 0xD2 || (op == 0xB2 && !read_bit(bit, false)));
+    }
+}
+
+void Sim8051::op_mov_c_bit(uint8_t) {
+    set_carry(read_bit(fetch()));
+}
+
+void Sim8051::op_mov_bit_c(uint8_t) {
+    write_bit(fetch(), carry());
+}
+
+// MOV A,src
+void Sim8051::op_mov_a(uint8_t op) {
+    acc() = read_operand(op);
+}
+
+// MOV dst,A
+void Sim8051::op_mov_from_a(uint8_t op) {
+    switch (op & 0x0F) {
+    case 0x05: write_direct(fetch(), acc()); break;
+    case 0x06: case 0x07: iram_[ri_address(op)] = acc(); break;
+    default: reg(op & 0x07) = acc(); break;
+    }
+}
+
+// MOV A,#data / MOV direct,#data / MOV @Ri,#data / MOV Rn,#data
+void Sim8051::op_mov_immediate(uint8_t op) {
+    switch (op & 0x0F) {
+    case 0x04: acc() = fetch(); break;
+    case 0x05: {
+        uint8_t address = fetch();
+
+        write_direct(address, fetch());
+        break;
+    }
+    case 0x06: case 0x07: iram_[ri_address(op)] = fetch(); break;
+    default: reg(op & 0x07) = fetch(); break;
+    }
+}
+
+// MOV direct,direct is encoded source first
+void Sim8051::op_mov_direct_direct(uint8_t) {
+    uint8_t source = fetch();
+
+    write_direct(fetch(), read_direct(source, true));
+}
+
+// MOV direct,@Ri / MOV direct,Rn
+void Sim8051::op_mov_to_direct(uint8_t op) {
+    uint8_t address = fetch();
+
+    write_direct(address, read_operand(op));
+}
+
+// MOV @Ri,direct / MOV Rn,direct
+void Sim8051::op_mov_from_direct(uint8_t op) {
+    uint8_t value = read_direct(fetch(), true);
+
+    if ((op & 0x0F) < 0x08)
+        iram_[ri_address(op)] = value;
+    else
+        reg(op & 0x07) = value;
+}
+
+void Sim8051::op_mov_dptr(uint8_t) {
+    sfr_[SFR_DPH] = fetch();
+    sfr_[SFR_DPL] = fetch();
+}
+
+void Sim8051::op_movc(uint8_t op) {
+    uint16_t base = (op == 0x83) ? pc_ : dptr();
+
+    acc() = code_[(uint16_t)(base + acc())];
+}
+
+void Sim8051::op_movx_read(uint8_t op) {
+    if (op == 0xE0)
+        acc() = read_xram(dptr());
+    else
+        acc() = read_xram((uint16_t)((sfr_[SFR_P2] << 8) | iram_[ri_address(op)]));
+}
+
+void Sim8051::op_movx_write(uint8_t op) {
+    if (op == 0xF0)
+        write_xram(dptr(), acc());
+    else
+        write_xram((uint16_t)((sfr_[SFR_P2] << 8) | iram_[ri_address(op)]), acc());
+}
+
+void Sim8051::op_push(uint8_t) {
+    push(read_direct(fetch(), true));
+}
+
+void Sim8051::op_pop(uint8_t) {
+    uint8_t address = fetch();
+
+    write_direct(address, pop());
+}
+
+void Sim8051::op_xch(uint8_t op) {
+    uint8_t a = acc();
+
+    switch (op & 0x0F) {
+    case 0x05: {
+        uint8_t address = fetch();
+
+        acc() = read_direct(address);
+        write_direct(address, a);
+        break;
+    }
+    case 0x06: case 0x07: {
+        uint8_t &target = iram_[ri_address(op)];
+
+        acc() = target;
+        target = a;
+        break;
+    }
+    default: {
+        uint8_t &target = reg(op & 0x07);
+
+        acc() = target;
+        target = a;
+        break;
+    }
+    }
+}
+
+void Sim8051::op_xchd(uint8_t op) {
+    uint8_t &target = iram_[ri_address(op)];
+    uint8_t a = acc();
+
+    acc() = (uint8_t)((a & 0xF0) | (target & 0x0F));
+    target = (uint8_t)((target & 0xF0) | (a & 0x0F));
+}
@@ -0,0 +1,249 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    sim8051.h
+ * @brief   Header file for the host-side AT89C51ED2 instruction-set simulator.
+ * @details Models what the monitor, the memory editor and the user programs
+ *          touch on the board: 64 KB code, 32 KB XRAM, 256 bytes of IRAM,
+ *          the SFRs with the dual data pointer, Timers 0 and 1, the PCA
+ *          counter, the internal baud rate generator, the UART and INT1.
+ *          Time is counted in machine cycles (12 clocks at 11.0592 MHz);
+ *          every instruction takes its data-sheet cycle count.
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+
+#ifndef _sim8051_H_
+#define _sim8051_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+#define SIM_FOSC (11059200UL)
+#define SIM_CODE_SIZE (0x10000)
+#define SIM_XRAM_SIZE (0x8000)
+#define SIM_IRAM_SIZE (0x100)
+#define SIM_UART_DEFAULT_BAUD (9600)
+
+class Sim8051 {
+public:
+    Sim8051();
+
+    /**
+     * @brief   Clears IRAM and the SFRs to their reset values, PC = 0.
+     * @details Code and XRAM are kept, as on the board.
+     * @param   None
+     * @return  None
+     */
+    void reset();
+
+    /**
+     * @brief   Adds an Intel HEX image to code memory.
+     * @details Several images (monitor, editor, user program) can be loaded
+     *          one after the other; bytes outside each file stay untouched.
+     * @param   path - Path of the .hex file.
+     * @return  0 on success, -1 on error (message already printed).
+     */
+    int load_hex(const char *path);
+
+    /**
+     * @brief   Executes one instruction, then lets an interrupt in.
+     * @param   None
+     * @return  Machine cycles taken, including a vector call.
+     */
+    unsigned step();
+
+    /**
+     * @brief   Runs until at least the given number of cycles has passed.
+     * @param   cycles - Machine cycles to run.
+     * @return  None
+     */
+    void run(uint64_t cycles);
+
+    /**
+     * @brief   Queues a byte on the RX line; it arrives one byte time later.
+     * @param   c - The byte sent by the host.
+     * @return  None
+     */
+    void uart_receive(uint8_t c);
+
+    /**
+     * @brief   Takes the next byte the target has finished transmitting.
+     * @param   c - Receives the byte.
+     * @return  true if a byte was available.
+     */
+    bool uart_transmit(uint8_t *c);
+
+    /**
+     * @brief   Tells whether the CPU is spinning on RI with nothing to read.
+     * @details True after a "JNB RI,$" with an empty RX line and no interrupt
+     *          enabled, so the caller can block on its input instead.
+     * @param   None
+     * @return  true if nothing can change until a byte is received.
+     */
+    bool idle() const { return idle_; }
+
+    /**
+     * @brief   Drives the INT1 pin (P3.3); low is the single-step jumper.
+     * @param   low - true to pull the pin low.
+     * @return  None
+     */
+    void set_int1(bool low) { int1_low_ = low; }
+
+    /**
+     * @brief   Makes every UART byte take one cycle instead of a byte time.
+     * @param   fast - true to skip the baud rate timing.
+     * @return  None
+     */
+    void set_fast_uart(bool fast) { fast_uart_ = fast; }
+
+    /**
+     * @brief   Moves the interrupt vectors, as the monitor's forwarding does.
+     * @details The monitor at 0x0000 hands the serial interrupt on to
+     *          0x2023, so the memory editor can run alone with base 0x2000.
+     * @param   base - Address added to every vector.
+     * @return  None
+     */
+    void set_vector_base(uint16_t base) { vector_base_ = base; }
+
+    /**
+     * @brief   Moves the program counter, e.g. to start a user program alone.
+     * @param   pc - New program counter.
+     * @return  None
+     */
+    void set_pc(uint16_t pc) { pc_ = pc; }
+
+    uint16_t pc() const { return pc_; }
+    uint64_t cycles() const { return cycles_; }
+    uint64_t instructions() const { return instructions_; }
+    uint64_t tx_bytes() const { return tx_count_; }
+    uint64_t rx_bytes() const { return rx_count_; }
+    size_t rx_pending() const { return rx_line_.size(); }
+    uint8_t code(uint16_t address) const { return code_[address]; }
+    uint8_t xram(uint16_t address) const;
+    uint8_t iram(uint8_t address) const { return iram_[address]; }
+    uint8_t sfr(uint8_t address) const { return sfr_[address & 0x7F]; }
+
+private:
+    typedef void (Sim8051::*Handler)(uint8_t op);
+
+    static Handler dispatch_[256];
+    static const uint8_t cycle_table_[256];
+    static void build_dispatch();
+
+    uint8_t fetch() { return code_[pc_++]; }
+    uint8_t &reg(uint8_t n) { return iram_[(sfr_[0x50] & 0x18) | n]; }
+    uint8_t &acc() { return sfr_[0x60]; }
+    uint8_t read_direct(uint8_t address, bool pins = false);
+    void write_direct(uint8_t address, uint8_t value);
+    bool read_bit(uint8_t bit, bool pins = true);
+    void write_bit(uint8_t bit, bool value);
+    uint8_t read_operand(uint8_t op);
+    uint8_t ri_address(uint8_t op) { return reg(op & 1); }
+    uint16_t dptr() const { return (uint16_t)((sfr_[0x03] << 8) | sfr_[0x02]); }
+    void set_dptr(uint16_t value);
+    uint8_t read_xram(uint16_t address) const;
+    void write_xram(uint16_t address, uint8_t value);
+    void push(uint8_t value);
+    uint8_t pop();
+    void relative_jump(uint8_t offset) { pc_ = (uint16_t)(pc_ + (int8_t)offset); }
+    void add(uint8_t value, bool carry);
+    void subtract(uint8_t value);
+    void set_carry(bool carry);
+    bool carry() const { return (sfr_[0x50] & 0x80) != 0; }
+
+    void tick(unsigned cycles);
+    void tick_timer(unsigned n, unsigned cycles);
+    unsigned tick_interrupts();
+    unsigned byte_cycles() const;
+
+    void op_nop(uint8_t op);
+    void op_reserved(uint8_t op);
+    void op_ajmp(uint8_t op);
+    void op_acall(uint8_t op);
+    void op_ljmp(uint8_t op);
+    void op_lcall(uint8_t op);
+    void op_ret(uint8_t op);
+    void op_reti(uint8_t op);
+    void op_sjmp(uint8_t op);
+    void op_jmp_dptr(uint8_t op);
+    void op_jbit(uint8_t op);
+    void op_jcarry(uint8_t op);
+    void op_jzero(uint8_t op);
+    void op_cjne(uint8_t op);
+    void op_djnz(uint8_t op);
+    void op_rotate(uint8_t op);
+    void op_inc(uint8_t op);
+    void op_dec(uint8_t op);
+    void op_inc_dptr(uint8_t op);
+    void op_add(uint8_t op);
+    void op_subb(uint8_t op);
+    void op_logic_a(uint8_t op);
+    void op_logic_direct(uint8_t op);
+    void op_logic_carry(uint8_t op);
+    void op_mul(uint8_t op);
+    void op_div(uint8_t op);
+    void op_da(uint8_t op);
+    void op_swap(uint8_t op);
+    void op_clr_a(uint8_t op);
+    void op_cpl_a(uint8_t op);
+    void op_bit(uint8_t op);
+    void op_mov_c_bit(uint8_t op);
+    void op_mov_bit_c(uint8_t op);
+    void op_mov_a(uint8_t op);
+    void op_mov_from_a(uint8_t op);
+    void op_mov_immediate(uint8_t op);
+    void op_mov_direct_direct(uint8_t op);
+    void op_mov_to_direct(uint8_t op);
+    void op_mov_from_direct(uint8_t op);
+    void op_mov_dptr(uint8_t op);
+    void op_movc(uint8_t op);
+    void op_movx_read(uint8_t op);
+    void op_movx_write(uint8_t op);
+    void op_push(uint8_t op);
+    void op_pop(uint8_t op);
+    void op_xch(uint8_t op);
+    void op_xchd(uint8_t op);
+
+    uint8_t code_[SIM_CODE_SIZE];
+    uint8_t xram_[SIM_XRAM_SIZE];
+    uint8_t iram_[SIM_IRAM_SIZE];
+    uint8_t sfr_[0x80];
+    uint16_t pc_;
+    uint64_t cycles_;
+    uint64_t instructions_;
+
+    // The DPTR not selected by AUXR1.DPS
+    uint8_t other_dpl_, other_dph_;
+
+    // Interrupt levels in service (bit n = level n), and the one-instruction
+    // delay after RETI and writes to IE/IP
+    uint8_t in_service_;
+    uint16_t vector_base_;
+    bool interrupt_hold_;
+    bool int1_low_, int1_last_;
+
+    bool fast_uart_;
+    bool idle_;
+    uint8_t sbuf_rx_;
+    bool tx_busy_, rx_busy_;
+    uint8_t tx_shift_;
+    uint64_t tx_done_, rx_done_;
+    uint64_t tx_count_, rx_count_;
+    std::deque<uint8_t> rx_line_;
+    std::deque<uint8_t> tx_line_;
+};
+
+#endif
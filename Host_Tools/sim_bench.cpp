@@ -0,0 +1,517 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    sim_bench.cpp
+ * @brief   Times firmware operations on the simulator from a script.
+ * @details Runs the images on Sim8051, feeds the UART from a bench script
+ *          and writes one CSV row per operation: machine cycles and the
+ *          bytes that crossed the wire in each direction.
+ *
+ *          Usage: sim_bench [-g] [-x] [-e] [-p pc] [-v base] [-m map]
+ *                           [-t cycles] [-o out.csv] <script> <hex>...
+ *
+ *          Script lines (strings in double quotes take \r \n \t \\ \" \xHH):
+ *            func <name> <symbol|0xADDR|*0xVECTOR>
+ *                 times every call of a function over the whole run, from
+ *                 its first instruction until it returns to its caller.
+ *                 *0xVECTOR follows the LJMP at an interrupt vector.
+ *            expect "<text>"
+ *                 runs untimed until the target has printed text
+ *            delay <cycles>
+ *                 runs untimed for a number of machine cycles
+ *            repeat <n>
+ *                 runs the next op n times
+ *            op <name> "<send>" "<until>" | <bytes> [frame <sync>]
+ *                 sends the bytes and times until the target has printed
+ *                 the text, or the given number of bytes. Rows of ops with
+ *                 the same name are merged. With frame, the bytes must
+ *                 start with the hex sync byte and the rest must sum to
+ *                 zero modulo 256, as the monitor's snapshot frames do;
+ *                 otherwise the run fails.
+ *
+ *          The CSV also gives the target's transmit rate over each op in
+ *          bytes per second of simulated time.
+ *
+ *          -e copies the target output to stderr, -t is the timeout per
+ *          step (default 2000000000 cycles); the other options are those
+ *          of sim51.
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "sim8051.h"
+#include "symmap.h"
+
+#define LINE_MAX_LENGTH (512)
+#define DEFAULT_TIMEOUT (2000000000ULL)
+#define TAIL_LENGTH (200)
+#define SFR_ADDRESS_SP (0x81)
+#define OPCODE_LJMP (0x02)
+#define MACHINE_CYCLES_PER_SECOND (SIM_FOSC / 12)
+
+enum step_kind { STEP_EXPECT, STEP_DELAY, STEP_OP };
+
+typedef struct {
+    enum step_kind kind;
+    int line;
+    std::string name;
+    std::string send;
+    std::string until;
+    unsigned long bytes;
+    unsigned long repeat;
+    int sync;                   // Frame sync byte to check, or -1
+} step_t;
+
+// Cycle and byte counts of one op or function
+typedef struct {
+    std::string name;
+    const char *kind;
+    unsigned long count;
+    uint64_t cycles;
+    uint64_t min_cycles;
+    uint64_t max_cycles;
+    uint64_t tx_bytes;
+    uint64_t rx_bytes;
+} result_t;
+
+typedef struct {
+    uint16_t address;
+    bool active;
+    uint8_t sp;
+    uint16_t return_address;
+    uint64_t start_cycles;
+    uint64_t start_tx;
+    size_t result;
+} probe_t;
+
+static Sim8051 sim;
+static std::vector<probe_t> probes;
+static std::vector<result_t> results;
+static std::string output;
+static bool echo;
+
+
+static void usage(void);
+static int parse_string(const char **p, std::string *out);
+static int parse_word(const char **p, std::string *out);
+static int resolve(const char *text, const symmap_t *map, uint16_t *address);
+static size_t find_result(const std::string &name, const char *kind);
+static void record(size_t index, uint64_t cycles, uint64_t tx, uint64_t rx);
+static void check_probes(void);
+static void collect_output(void);
+static bool step_done(const step_t &step, size_t mark, uint64_t end);
+static int run_until(const step_t &step, uint64_t timeout);
+static int check_frame(const step_t &step, size_t mark);
+static int load_script(const char *path, const symmap_t *map, std::vector<step_t> *steps);
+static int write_results(const char *path);
+
+
+static void usage(void) {
+    fprintf(stderr, "usage: sim_bench [-g] [-x] [-e] [-p pc] [-v base] [-m map] [-t cycles] [-o out.csv]"
+                    " <script> <hex>...\n");
+    exit(2);
+}
+
+static int parse_string(const char **p, std::string *out) {
+    const char *s = *p;
+
+    out->clear();
+    if (*s != '"')
+        return -1;
+    s++;
+    while (*s && *s != '"') {
+        char c = *s++;
+
+        if (c == '\\') {
+            c = *s++;
+            switch (c) {
+            case 'r': c = '\r'; break;
+            case 'n': c = '\n'; break;
+            case 't': c = '\t'; break;
+            case 'x': {
+                char digits[3] = { 0, 0, 0 };
+
+                if (!isxdigit((unsigned char)s[0]) || !isxdigit((unsigned char)s[1]))
+                    return -1;
+                digits[0] = s[0];
+                digits[1] = s[1];
+                s += 2;
+                c = (char)strtoul(digits, NULL, 16);
+                break;
+            }
+            case '\\': case '"': break;
+            default: return -1;
+            }
+        }
+        out->push_back(c);
+    }
+    if (*s != '"')
+        return -1;
+    *p = s + 1;
+    return 0;
+}
+
+static int parse_word(const char **p, std::string *out) {
+    const char *s = *p;
+
+    while (*s == ' ' || *s == '\t')
+        s++;
+    out->clear();
+    if (*s == '"') {
+        *p = s;
+        return parse_string(p, out);
+    }
+    while (*s && !isspace((unsigned char)*s))
+        out->push_back(*s++);
+    *p = s;
+    return out->empty() ? -1 : 0;
+}
+
+static int resolve(const char *text, const symmap_t *map, uint16_t *address) {
+    if (text[0] == '*') {
+        uint16_t vector = (uint16_t)strtoul(text + 1, NULL, 16);
+
+        if (sim.code(vector) != OPCODE_LJMP)
+            return -1;
+        *address = (uint16_t)((sim.code(vector + 1) << 8) | sim.code(vector + 2));
+        return 0;
+    }
+    if (text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) {
+        *address = (uint16_t)strtoul(text, NULL, 16);
+        return 0;
+    }
+    for (size_t i = 0; i < map->count; i++) {
+        if (strcmp(map->symbols[i].name, text) == 0) {
+            *address = (uint16_t)map->symbols[i].address;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static size_t find_result(const std::string &name, const char *kind) {
+    result_t result;
+
+    for (size_t i = 0; i < results.size(); i++) {
+        if (results[i].name == name && strcmp(results[i].kind, kind) == 0)
+            return i;
+    }
+    result.name = name;
+    result.kind = kind;
+    result.count = 0;
+    result.cycles = result.min_cycles = result.max_cycles = 0;
+    result.tx_bytes = result.rx_bytes = 0;
+    results.push_back(result);
+    return results.size() - 1;
+}
+
+static void record(size_t index, uint64_t cycles, uint64_t tx, uint64_t rx) {
+    result_t &r = results[index];
+
+    if (!r.count || cycles < r.min_cycles)
+        r.min_cycles = cycles;
+    if (cycles > r.max_cycles)
+        r.max_cycles = cycles;
+    r.count++;
+    r.cycles += cycles;
+    r.tx_bytes += tx;
+    r.rx_bytes += rx;
+}
+
+/*
+ * A call ends when the PC reaches the return address with the stack back
+ * where it was before the call; interrupt handlers end the same way at
+ * their RETI. Recursive calls are counted once, at the outermost level.
+ */
+static void check_probes(void) {
+    uint16_t pc = sim.pc();
+    uint8_t sp = sim.sfr(SFR_ADDRESS_SP);
+
+    for (size_t i = 0; i < probes.size(); i++) {
+        probe_t &p = probes[i];
+
+        if (p.active) {
+            if (pc == p.return_address && sp == (uint8_t)(p.sp - 2)) {
+                p.active = false;
+                record(p.result, sim.cycles() - p.start_cycles, sim.tx_bytes() - p.start_tx, 0);
+            }
+        } else if (pc == p.address) {
+            p.active = true;
+            p.sp = sp;
+            p.return_address = (uint16_t)((sim.iram(sp) << 8) | sim.iram((uint8_t)(sp - 1)));
+            p.start_cycles = sim.cycles();
+            p.start_tx = sim.tx_bytes();
+        }
+    }
+}
+
+static void collect_output(void) {
+    uint8_t c;
+
+    while (sim.uart_transmit(&c)) {
+        output.push_back((char)c);
+        if (echo)
+            fputc(c, stderr);
+    }
+}
+
+static bool step_done(const step_t &step, size_t mark, uint64_t end) {
+    if (step.kind == STEP_DELAY)
+        return sim.cycles() >= end;
+    if (step.kind == STEP_OP && step.until.empty())
+        return output.size() - mark >= step.bytes;
+    return output.size() - mark >= step.until.size() &&
+           output.compare(output.size() - step.until.size(), step.until.size(), step.until) == 0;
+}
+
+static int run_until(const step_t &step, uint64_t timeout) {
+    size_t mark = output.size();
+    uint64_t start = sim.cycles();
+    uint64_t end = start + step.bytes;
+
+    while (!step_done(step, mark, end)) {
+        sim.step();
+        if (!probes.empty())
+            check_probes();
+        collect_output();
+        if (sim.cycles() - start > timeout) {
+            size_t tail = output.size() - mark > TAIL_LENGTH ? output.size() - TAIL_LENGTH : mark;
+
+            fprintf(stderr, "sim_bench: line %d: timeout, PC %04X, last output:\n%s\n", step.line,
+                    sim.pc(), output.substr(tail).c_str());
+            return -1;
+        }
+        if (sim.idle() && step.kind != STEP_DELAY) {
+            fprintf(stderr, "sim_bench: line %d: target waits for input, PC %04X\n", step.line, sim.pc());
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * A wrong monitor image or script still produces some bytes, so the byte
+ * count alone would time garbage; the frame check makes that a failure.
+ */
+static int check_frame(const step_t &step, size_t mark) {
+    uint8_t sum = 0;
+
+    if ((uint8_t)output[mark] != step.sync) {
+        fprintf(stderr, "sim_bench: line %d: expected frame sync %02X, got %02X\n", step.line,
+                step.sync, (uint8_t)output[mark]);
+        return -1;
+    }
+    for (size_t i = 1; i < step.bytes; i++)
+        sum += (uint8_t)output[mark + i];
+    if (sum != 0) {
+        fprintf(stderr, "sim_bench: line %d: frame checksum mismatch\n", step.line);
+        return -1;
+    }
+    return 0;
+}
+
+static int load_script(const char *path, const symmap_t *map, std::vector<step_t> *steps) {
+    FILE *in = fopen(path, "r");
+    char line[LINE_MAX_LENGTH];
+    unsigned long repeat = 1;
+    int number = 0;
+
+    if (!in) {
+        perror(path);
+        return -1;
+    }
+    while (fgets(line, sizeof(line), in)) {
+        const char *p = line;
+        std::string command, name, argument;
+        step_t step;
+
+        number++;
+        while (isspace((unsigned char)*p))
+            p++;
+        if (!*p || *p == '#')
+            continue;
+        parse_word(&p, &command);
+        step.line = number;
+        step.bytes = 0;
+        step.repeat = 1;
+        step.sync = -1;
+
+        if (command == "func") {
+            probe_t probe;
+
+            if (parse_word(&p, &name) < 0 || parse_word(&p, &argument) < 0)
+                goto syntax;
+            if (resolve(argument.c_str(), map, &probe.address) < 0) {
+                fprintf(stderr, "sim_bench: %s:%d: cannot find %s\n", path, number, argument.c_str());
+                fclose(in);
+                return -1;
+            }
+            probe.active = false;
+            probe.result = find_result(name, "func");
+            probes.push_back(probe);
+            continue;
+        } else if (command == "expect") {
+            step.kind = STEP_EXPECT;
+            if (parse_word(&p, &step.until) < 0)
+                goto syntax;
+        } else if (command == "delay") {
+            step.kind = STEP_DELAY;
+            if (parse_word(&p, &argument) < 0)
+                goto syntax;
+            step.bytes = strtoul(argument.c_str(), NULL, 10);
+        } else if (command == "repeat") {
+            if (parse_word(&p, &argument) < 0)
+                goto syntax;
+            repeat = strtoul(argument.c_str(), NULL, 10);
+            continue;
+        } else if (command == "op") {
+            step.kind = STEP_OP;
+            while (*p == ' ' || *p == '\t')
+                p++;
+            if (parse_word(&p, &step.name) < 0)
+                goto syntax;
+            while (*p == ' ' || *p == '\t')
+                p++;
+            if (parse_string(&p, &step.send) < 0)
+                goto syntax;
+            while (*p == ' ' || *p == '\t')
+                p++;
+            if (*p == '"') {
+                if (parse_string(&p, &step.until) < 0)
+                    goto syntax;
+            } else {
+                if (parse_word(&p, &argument) < 0)
+                    goto syntax;
+                step.bytes = strtoul(argument.c_str(), NULL, 10);
+                if (parse_word(&p, &argument) == 0) {
+                    if (argument != "frame" || parse_word(&p, &argument) < 0 || step.bytes < 2)
+                        goto syntax;
+                    step.sync = (int)(strtoul(argument.c_str(), NULL, 16) & 0xFF);
+                }
+            }
+            if (step.until.empty() && !step.bytes)
+                goto syntax;
+            step.repeat = repeat;
+            repeat = 1;
+            find_result(step.name, "op");
+        } else {
+            goto syntax;
+        }
+        steps->push_back(step);
+        continue;
+syntax:
+        fprintf(stderr, "sim_bench: %s:%d: syntax error\n", path, number);
+        fclose(in);
+        return -1;
+    }
+    fclose(in);
+    return 0;
+}
+
+static int write_results(const char *path) {
+    FILE *out = path ? fopen(path, "w") : stdout;
+
+    if (!out) {
+        perror(path);
+        return -1;
+    }
+    fprintf(out, "name,kind,count,cycles,min_cycles,max_cycles,tx_bytes,rx_bytes,tx_bytes_per_s\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const result_t &r = results[i];
+        double rate = r.cycles ? (double)r.tx_bytes * MACHINE_CYCLES_PER_SECOND / r.cycles : 0.0;
+
+        fprintf(out, "%s,%s,%lu,%llu,%llu,%llu,%llu,%llu,%.0f\n", r.name.c_str(), r.kind, r.count,
+                (unsigned long long)r.cycles, (unsigned long long)r.min_cycles,
+                (unsigned long long)r.max_cycles, (unsigned long long)r.tx_bytes,
+                (unsigned long long)r.rx_bytes, rate);
+    }
+    if (path)
+        fclose(out);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    std::vector<step_t> steps;
+    symmap_t map = { NULL, 0 };
+    const char *map_path = NULL, *out_path = NULL;
+    unsigned long start_pc = 0;
+    uint64_t timeout = DEFAULT_TIMEOUT;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "gxep:v:m:t:o:")) != -1) {
+        if (opt == 'g')
+            sim.set_int1(true);
+        else if (opt == 'x')
+            sim.set_fast_uart(true);
+        else if (opt == 'e')
+            echo = true;
+        else if (opt == 'p')
+            start_pc = strtoul(optarg, NULL, 16);
+        else if (opt == 'v')
+            sim.set_vector_base((uint16_t)strtoul(optarg, NULL, 16));
+        else if (opt == 'm')
+            map_path = optarg;
+        else if (opt == 't')
+            timeout = strtoull(optarg, NULL, 10);
+        else if (opt == 'o')
+            out_path = optarg;
+        else
+            usage();
+    }
+    if (argc - optind < 2)
+        usage();
+    for (int i = optind + 1; i < argc; i++) {
+        if (sim.load_hex(argv[i]) < 0)
+            return 1;
+    }
+    if (map_path && symmap_load(map_path, &map) < 0)
+        return 1;
+    if (load_script(argv[optind], &map, &steps) < 0)
+        return 1;
+    symmap_free(&map);
+
+    sim.reset();
+    sim.set_pc((uint16_t)start_pc);
+    for (size_t i = 0; i < steps.size(); i++) {
+        const step_t &step = steps[i];
+
+        for (unsigned long n = 0; n < step.repeat; n++) {
+            uint64_t cycles = sim.cycles();
+            uint64_t tx = sim.tx_bytes();
+            size_t mark = output.size();
+
+            for (size_t k = 0; k < step.send.size(); k++)
+                sim.uart_receive((uint8_t)step.send[k]);
+            if (run_until(step, timeout) < 0)
+                return 1;
+            if (step.sync >= 0 && check_frame(step, mark) < 0)
+                return 1;
+            if (step.kind == STEP_OP)
+                record(find_result(step.name, "op"), sim.cycles() - cycles, sim.tx_bytes() - tx,
+                       step.send.size());
+        }
+    }
+
+    for (size_t i = 0; i < probes.size(); i++) {
+        if (!results[probes[i].result].count)
+            fprintf(stderr, "sim_bench: %s never returned\n", results[probes[i].result].name.c_str());
+    }
+    return write_results(out_path) < 0 ? 1 : 0;
+}
@@ -0,0 +1,136 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    snapshot.c
+ * @brief   Receives and renders the monitor's register snapshot frames.
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+#include "serial.h"
+#include "snapshot.h"
+
+
+static int receive_delta(int fd, snapshot_t *snap);
+
+
+static int receive_delta(int fd, snapshot_t *snap) {
+    uint8_t frame[2 + SNAPSHOT_DELTA_REGS + 3];
+    uint8_t sum = 0, parity = 0;
+    unsigned mask = 0, length = 2, step;
+    unsigned long total;
+    int c;
+
+    // Mask first, it gives the length of the rest
+    for (unsigned i = 0; i < length; i++) {
+        c = serial_read_byte(fd, SNAPSHOT_TIMEOUT_MS);
+        if (c < 0)
+            return -1;
+        frame[i] = (uint8_t)c;
+        sum += (uint8_t)c;
+        if (i == 1) {
+            mask = ((unsigned)frame[0] << 8) | frame[1];
+            for (int r = 0; r < SNAPSHOT_DELTA_REGS; r++)
+                length += (mask >> r) & 1;
+            length += 3;
+        }
+    }
+    c = serial_read_byte(fd, SNAPSHOT_TIMEOUT_MS);
+    if (c < 0)
+        return -1;
+    if ((uint8_t)(sum + c) != 0)
+        return -2;
+    if (!snap->timed)
+        return -3;
+
+    length = 2;
+    for (int r = 0; r < SNAPSHOT_DELTA_REGS; r++) {
+        if ((mask >> r) & 1)
+            snap->reg[r] = frame[length++];
+    }
+    for (uint8_t a = snap->reg[SNAP_ACC]; a; a >>= 1)
+        parity ^= a & 1;
+    snap->reg[SNAP_PSW] = (uint8_t)((snap->reg[SNAP_PSW] & 0xFE) | parity);
+    snap->reg[SNAP_PCH] = frame[length];
+    snap->reg[SNAP_PCL] = frame[length + 1];
+    step = frame[length + 2];
+    total = (mask & SNAPSHOT_DELTA_RESTART) ? step : snapshot_total(snap) + step;
+    snap->reg[SNAP_CYCLES] = 0;
+    snap->reg[SNAP_CYCLES + 1] = (uint8_t)step;
+    for (int i = 3; i >= 0; i--, total >>= 8)
+        snap->reg[SNAP_TOTAL + i] = (uint8_t)total;
+    return 0;
+}
+
+int snapshot_receive(int fd, snapshot_t *snap, FILE *passthrough) {
+    uint8_t sum = 0;
+    int c;
+
+    for (;;) {
+        c = serial_read_byte(fd, SNAPSHOT_TIMEOUT_MS);
+        if (c < 0)
+            return -1;
+        if (c == SNAPSHOT_SYNC)
+            break;
+        if (c == SNAPSHOT_DELTA_SYNC)
+            return receive_delta(fd, snap);
+        if (passthrough)
+            fputc(c, passthrough);
+    }
+
+    for (int i = 0; i < SNAPSHOT_LENGTH; i++) {
+        c = serial_read_byte(fd, SNAPSHOT_TIMEOUT_MS);
+        if (c < 0)
+            return -1;
+        snap->reg[i] = (uint8_t)c;
+        sum += (uint8_t)c;
+    }
+    c = serial_read_byte(fd, SNAPSHOT_TIMEOUT_MS);
+    if (c < 0)
+        return -1;
+    snap->timed = 1;
+    return (uint8_t)(sum + c) == 0 ? 0 : -2;
+}
+
+unsigned snapshot_pc(const snapshot_t *snap) {
+    return ((unsigned)snap->reg[SNAP_PCH] << 8) | snap->reg[SNAP_PCL];
+}
+
+unsigned snapshot_cycles(const snapshot_t *snap) {
+    return ((unsigned)snap->reg[SNAP_CYCLES] << 8) | snap->reg[SNAP_CYCLES + 1];
+}
+
+unsigned long snapshot_total(const snapshot_t *snap) {
+    unsigned long total = 0;
+
+    for (int i = 0; i < 4; i++)
+        total = (total << 8) | snap->reg[SNAP_TOTAL + i];
+    return total;
+}
+
+void snapshot_print_header(FILE *out, int timed) {
+    fprintf(out, " ACC B  PSW DPTR R0 R1 R2 R3 R4 R5 R6 R7 SP PC  %s\n", timed ? "   CY     TOTAL" : "");
+}
+
+void snapshot_print(FILE *out, const snapshot_t *snap) {
+    const uint8_t *r = snap->reg;
+
+    fprintf(out, " %02X  %02X %02X  %02X%02X", r[SNAP_ACC], r[SNAP_B], r[SNAP_PSW],
+            r[SNAP_DPH], r[SNAP_DPL]);
+    for (int i = 0; i < 8; i++)
+        fprintf(out, " %02X", r[SNAP_R0 + i]);
+    fprintf(out, " %02X %04X", r[SNAP_SP], snapshot_pc(snap));
+    if (snap->timed)
+        fprintf(out, "  %5u %9lu", snapshot_cycles(snap), snapshot_total(snap));
+    fprintf(out, "\n");
+}
@@ -0,0 +1,115 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    snapshot.h
+ * @brief   Header file for the monitor's single-step register snapshots.
+ * @details Frame layout (see Single_Step_Keil_Compiler/cone.c):
+ *          0xA5, ACC, B, PSW, DPH, DPL, R0-R7, SP, PCH, PCL, user cycles of
+ *          the step (2 bytes), user cycles since the last stop (4 bytes),
+ *          checksum. Multi-byte values are high byte first. The checksum
+ *          makes the 22 data bytes plus itself sum to zero modulo 256.
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+
+#ifndef _snapshot_H_
+#define _snapshot_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define SNAPSHOT_SYNC (0xA5)
+#define SNAPSHOT_DELTA_SYNC (0xA6)
+#define SNAPSHOT_DELTA_REGS (14)        // ACC ... SP, bit n of the delta mask
+#define SNAPSHOT_DELTA_RESTART (0x4000) // Total restarts from this step
+#define SNAPSHOT_REGS (16)      // Register part, also used by trace keyframes
+#define SNAPSHOT_LENGTH (22)
+#define SNAPSHOT_TIMEOUT_MS (2000)
+
+// Byte offsets inside a snapshot, in the order the monitor sends them
+enum {
+    SNAP_ACC = 0,
+    SNAP_B,
+    SNAP_PSW,
+    SNAP_DPH,
+    SNAP_DPL,
+    SNAP_R0,
+    SNAP_SP = SNAP_R0 + 8,
+    SNAP_PCH,
+    SNAP_PCL,
+    SNAP_CYCLES,
+    SNAP_TOTAL = SNAP_CYCLES + 2
+};
+
+typedef struct {
+    uint8_t reg[SNAPSHOT_LENGTH];
+    int timed;                  // Cycle fields are valid
+} snapshot_t;
+
+/**
+ * @brief   Waits for the next snapshot or delta frame and validates its
+ *          checksum.
+ * @details Bytes outside frames (prompts, user program output) are copied
+ *          to passthrough so nothing the target prints is lost. A delta
+ *          frame only carries the registers that changed, so snap must
+ *          hold the state of the previous frame; PSW.P is recomputed from
+ *          ACC and the total is carried forward from the step cycles.
+ * @param   fd - Serial port file descriptor.
+ * @param   snap - Register state, updated in place.
+ * @param   passthrough - Stream for non-frame bytes, or NULL to drop them.
+ * @return  0 on success, -1 on timeout, -2 on checksum mismatch, -3 for a
+ *          delta frame without a full snapshot before it.
+ */
+int snapshot_receive(int fd, snapshot_t *snap, FILE *passthrough);
+
+/**
+ * @brief   Returns the program counter stored in a snapshot.
+ * @param   snap - Snapshot to read.
+ * @return  PC value.
+ */
+unsigned snapshot_pc(const snapshot_t *snap);
+
+/**
+ * @brief   Returns the user cycles of the step a snapshot reports.
+ * @param   snap - Snapshot to read.
+ * @return  Machine cycles, monitor overhead already removed.
+ */
+unsigned snapshot_cycles(const snapshot_t *snap);
+
+/**
+ * @brief   Returns the user cycles since the last breakpoint stop.
+ * @param   snap - Snapshot to read.
+ * @return  Machine cycles.
+ */
+unsigned long snapshot_total(const snapshot_t *snap);
+
+/**
+ * @brief   Prints the column header of the register table.
+ * @param   out - Output stream.
+ * @param   timed - Non-zero to include the cycle columns.
+ * @return  None
+ */
+void snapshot_print_header(FILE *out, int timed);
+
+/**
+ * @brief   Prints a snapshot as one row of the register table.
+ * @details Same layout as the monitor's own ASCII output. The cycle
+ *          columns are printed only for timed snapshots.
+ * @param   out - Output stream.
+ * @param   snap - Snapshot to print.
+ * @return  None
+ */
+void snapshot_print(FILE *out, const snapshot_t *snap);
+
+#endif
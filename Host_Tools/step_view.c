@@ -0,0 +1,136 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    step_view.c
+ * @brief   Host front end for the monitor's single-step mode.
+ * @details Starts single-stepping at the given address with binary
+ *          snapshot frames and renders each frame as a row of the register
+ *          table with the user cycles of the instruction and the running
+ *          total since the last breakpoint, so the target only sends 24
+ *          bytes per instruction. With -d the monitor sends delta frames
+ *          with only the registers that changed, typically 7-8 bytes, and
+ *          the full rows are rebuilt here.
+ *
+ *          Usage: step_view [-i baud] [-b baud] [-d] [-n steps] <port> <address>
+ *
+ *          Without -n, Enter steps one instruction and 'e' leaves
+ *          single-step mode. With -n the given number of rows is printed
+ *          without waiting and single-step mode is then left.
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "serial.h"
+#include "snapshot.h"
+
+#define PROMPT_TIMEOUT_MS (2000)
+#define QUIET_MS (300)
+
+
+static void usage(void);
+static int start_stepping(int fd, unsigned long address, int delta);
+
+
+static void usage(void) {
+    fprintf(stderr, "usage: step_view [-i baud] [-b baud] [-d] [-n steps] <port> <address>\n");
+    exit(2);
+}
+
+static int start_stepping(int fd, unsigned long address, int delta) {
+    char request[8];
+
+    // 'S', the four address digits, then 'B' or 'D' at the output mode prompt
+    snprintf(request, sizeof(request), "S%04lX", address);
+    if (serial_write(fd, request, 5) < 0)
+        return -1;
+    if (serial_expect(fd, "frames: ", PROMPT_TIMEOUT_MS) < 0) {
+        fprintf(stderr, "step_view: no output mode prompt (is P3.3 grounded?)\n");
+        return -1;
+    }
+    return serial_write(fd, delta ? "D" : "B", 1);
+}
+
+int main(int argc, char **argv) {
+    long initial_baud = SERIAL_DEFAULT_BAUD;
+    long baud = 0;
+    long steps = -1;
+    int delta = 0;
+    unsigned long address;
+    snapshot_t snap = { { 0 }, 0 };
+    char *end;
+    int opt, fd;
+
+    while ((opt = getopt(argc, argv, "i:b:dn:")) != -1) {
+        if (opt == 'i')
+            initial_baud = strtol(optarg, NULL, 10);
+        else if (opt == 'b')
+            baud = strtol(optarg, NULL, 10);
+        else if (opt == 'd')
+            delta = 1;
+        else if (opt == 'n')
+            steps = strtol(optarg, NULL, 10);
+        else
+            usage();
+    }
+    if (argc - optind != 2)
+        usage();
+    address = strtoul(argv[optind + 1], &end, 16);
+    if (*end != '\0' || address > 0xFFFF) {
+        fprintf(stderr, "step_view: invalid address\n");
+        return 2;
+    }
+
+    fd = serial_open(argv[optind], initial_baud);
+    if (fd < 0)
+        return 1;
+    if (baud && serial_negotiate_baud(fd, initial_baud, baud) < 0)
+        return 1;
+    serial_drain(fd, QUIET_MS);
+    if (start_stepping(fd, address, delta) < 0)
+        return 1;
+
+    snapshot_print_header(stdout, 1);
+    for (long count = 0;; count++) {
+        char line[16];
+        int status = snapshot_receive(fd, &snap, stderr);
+
+        if (status == -1) {
+            fprintf(stderr, "step_view: timeout waiting for a snapshot\n");
+            return 1;
+        }
+        if (status == -2)
+            fprintf(stderr, "step_view: checksum mismatch, row dropped\n");
+        else if (status == -3)
+            fprintf(stderr, "step_view: delta frame before the first snapshot, row dropped\n");
+        else
+            snapshot_print(stdout, &snap);
+        fflush(stdout);
+
+        if (steps >= 0) {
+            if (count + 1 >= steps)
+                break;
+        } else if (!fgets(line, sizeof(line), stdin) || line[0] == 'e' || line[0] == 'E') {
+            break;
+        }
+        if (serial_write(fd, "\r", 1) < 0)
+            return 1;
+    }
+
+    serial_write(fd, "E", 1);
+    close(fd);
+    return 0;
+}
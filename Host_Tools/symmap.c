@@ -0,0 +1,110 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    symmap.c
+ * @brief   Parses the code symbols out of an SDCC linker map.
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "symmap.h"
+
+
+static int compare_symbols(const void *a, const void *b);
+
+
+static int compare_symbols(const void *a, const void *b) {
+    const symbol_t *x = a, *y = b;
+
+    if (x->address != y->address)
+        return x->address < y->address ? -1 : 1;
+    // C function names first among aliases of one address
+    return (y->name[0] == '_') - (x->name[0] == '_');
+}
+
+int symmap_load(const char *path, symmap_t *map) {
+    FILE *in = fopen(path, "r");
+    char line[256];
+    size_t capacity = 0;
+
+    map->symbols = NULL;
+    map->count = 0;
+    if (!in) {
+        perror(path);
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), in)) {
+        unsigned address;
+        char name[40];
+
+        // e.g. "C:   0000409D  _main                              main"
+        if (sscanf(line, " C: %x %39s", &address, name) != 2)
+            continue;
+        if (strncmp(name, "s_", 2) == 0 || strncmp(name, "l_", 2) == 0)
+            continue;
+        if (map->count == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            map->symbols = realloc(map->symbols, capacity * sizeof(symbol_t));
+            if (!map->symbols) {
+                perror("symmap");
+                fclose(in);
+                return -1;
+            }
+        }
+        map->symbols[map->count].address = address;
+        strcpy(map->symbols[map->count].name, name);
+        map->count++;
+    }
+    fclose(in);
+
+    qsort(map->symbols, map->count, sizeof(symbol_t), compare_symbols);
+    // Keep one name per address
+    size_t kept = 0;
+    for (size_t i = 0; i < map->count; i++) {
+        if (kept && map->symbols[kept - 1].address == map->symbols[i].address)
+            continue;
+        map->symbols[kept++] = map->symbols[i];
+    }
+    map->count = kept;
+    if (map->count == 0) {
+        fprintf(stderr, "%s: no code symbols found\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+long symmap_find(const symmap_t *map, unsigned address) {
+    long low = 0, high = (long)map->count - 1, found = -1;
+
+    while (low <= high) {
+        long mid = (low + high) / 2;
+
+        if (map->symbols[mid].address <= address) {
+            found = mid;
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return found;
+}
+
+void symmap_free(symmap_t *map) {
+    free(map->symbols);
+    map->symbols = NULL;
+    map->count = 0;
+}
@@ -0,0 +1,72 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    symmap.h
+ * @brief   Header file for reading code symbols from an SDCC .map file.
+ * @details Collects the "C:" (code space) symbols of the linker map, such
+ *          as Example_User_program_SDCC/bin/exec.map, sorted by address so
+ *          a code address can be mapped back to the function holding it.
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+
+#ifndef _symmap_H_
+#define _symmap_H_
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    unsigned address;
+    char name[40];
+} symbol_t;
+
+typedef struct {
+    symbol_t *symbols;
+    size_t count;
+} symmap_t;
+
+/**
+ * @brief   Loads the code symbols of a linker map.
+ * @details Area start/length markers (s_, l_) are skipped; when several
+ *          names share an address the C function name (leading '_') wins.
+ * @param   path - Path of the .map file.
+ * @param   map - Receives the sorted symbol table.
+ * @return  0 on success, -1 on error (message already printed).
+ */
+int symmap_load(const char *path, symmap_t *map);
+
+/**
+ * @brief   Finds the symbol whose range contains an address.
+ * @param   map - Loaded symbol table.
+ * @param   address - Code address.
+ * @return  Index of the last symbol at or below address, or -1.
+ */
+long symmap_find(const symmap_t *map, unsigned address);
+
+/**
+ * @brief   Frees a symbol table.
+ * @param   map - Table to free.
+ * @return  None
+ */
+void symmap_free(symmap_t *map);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
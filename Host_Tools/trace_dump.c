@@ -0,0 +1,234 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    trace_dump.c
+ * @brief   Downloads and decodes the monitor's execution trace.
+ * @details Sends 'T' 'D', receives the trace ring in one burst and expands
+ *          the delta records into one register row per step, oldest first.
+ *          The PC of each row is the next instruction to execute.
+ *
+ *          Usage: trace_dump [-i baud] [-b baud] [-o raw] [-n rows] <port>
+ *                 trace_dump [-n rows] -f raw
+ *
+ *          -o also saves the raw ring, -f decodes a saved one offline and
+ *          -n prints only the last rows.
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "serial.h"
+#include "snapshot.h"
+
+// Record format, see the trace section of Single_Step_Keil_Compiler/cone.c
+#define TRACE_BLOCKS (16)
+#define TRACE_BLOCK_SIZE (256)
+#define TRACE_KEYFRAME (0x80)
+#define TRACE_END (0xFF)
+#define TRACE_ACC (0x10)
+#define TRACE_DUMP_SYNC (0x5A)
+#define TRACE_TIMEOUT_MS (2000)
+#define QUIET_MS (300)
+
+
+static void usage(void);
+static int receive_trace(int fd, uint8_t *ring, int *blocks);
+static long decode_block(const uint8_t *block, snapshot_t *rows, long capacity);
+
+
+static void usage(void) {
+    fprintf(stderr, "usage: trace_dump [-i baud] [-b baud] [-o raw] [-n rows] <port>\n"
+                    "       trace_dump [-n rows] -f raw\n");
+    exit(2);
+}
+
+static int receive_trace(int fd, uint8_t *ring, int *blocks) {
+    unsigned sum = 0;
+    int c, hi, lo;
+
+    if (serial_write(fd, "TD", 2) < 0)
+        return -1;
+    do {
+        c = serial_read_byte(fd, TRACE_TIMEOUT_MS);
+        if (c < 0) {
+            fprintf(stderr, "trace_dump: no trace from the monitor\n");
+            return -1;
+        }
+    } while (c != TRACE_DUMP_SYNC);
+
+    *blocks = serial_read_byte(fd, TRACE_TIMEOUT_MS);
+    if (*blocks <= 0 || *blocks > TRACE_BLOCKS) {
+        fprintf(stderr, "trace_dump: bad block count\n");
+        return -1;
+    }
+    for (int i = 0; i < *blocks * TRACE_BLOCK_SIZE; i++) {
+        c = serial_read_byte(fd, TRACE_TIMEOUT_MS);
+        if (c < 0) {
+            fprintf(stderr, "trace_dump: timeout at byte %d\n", i);
+            return -1;
+        }
+        ring[i] = (uint8_t)c;
+        sum += (unsigned)c;
+        if ((i & 0xFF) == 0xFF)
+            fprintf(stderr, "\rblock %d / %d", (i >> 8) + 1, *blocks);
+    }
+    fprintf(stderr, "\n");
+    hi = serial_read_byte(fd, TRACE_TIMEOUT_MS);
+    lo = serial_read_byte(fd, TRACE_TIMEOUT_MS);
+    if (hi < 0 || lo < 0 || (uint16_t)sum != (uint16_t)((hi << 8) | lo)) {
+        fprintf(stderr, "trace_dump: checksum mismatch\n");
+        return -1;
+    }
+    return 0;
+}
+
+static long decode_block(const uint8_t *block, snapshot_t *rows, long capacity) {
+    snapshot_t state = { { 0 }, 0 };
+    long count = 0;
+    int i = 1 + SNAPSHOT_REGS;
+
+    if (block[0] != TRACE_KEYFRAME)
+        return 0;
+    memcpy(state.reg, block + 1, SNAPSHOT_REGS);
+    rows[count++] = state;
+
+    while (i < TRACE_BLOCK_SIZE && block[i] != TRACE_END && count < capacity) {
+        uint8_t ctrl = block[i++];
+        unsigned pc = snapshot_pc(&state);
+        int pairs = ctrl & 0x0F;
+        int length = 2 * pairs;
+        uint8_t parity = 0;
+
+        if (ctrl & TRACE_KEYFRAME) {
+            fprintf(stderr, "trace_dump: bad record %02X, rest of block skipped\n", ctrl);
+            break;
+        }
+        if ((ctrl & 0x60) == 0)
+            length += 2;
+        if (ctrl & TRACE_ACC)
+            length++;
+        // Check the whole record first, so a corrupt control byte in the
+        // last block cannot read past the ring
+        if (length > TRACE_BLOCK_SIZE - i) {
+            fprintf(stderr, "trace_dump: record runs past its block\n");
+            break;
+        }
+        if ((ctrl & 0x60) == 0) {
+            pc = (block[i] << 8) | block[i + 1];
+            i += 2;
+        } else {
+            pc += (ctrl >> 5) & 0x03;
+        }
+        state.reg[SNAP_PCH] = (uint8_t)(pc >> 8);
+        state.reg[SNAP_PCL] = (uint8_t)pc;
+        if (ctrl & TRACE_ACC)
+            state.reg[SNAP_ACC] = block[i++];
+        while (pairs--) {
+            uint8_t index = block[i++];
+
+            if (index < SNAP_PCH)
+                state.reg[index] = block[i];
+            i++;
+        }
+        // The monitor does not record PSW.P, which always follows ACC
+        for (uint8_t a = state.reg[SNAP_ACC]; a; a >>= 1)
+            parity ^= a & 1;
+        state.reg[SNAP_PSW] = (uint8_t)((state.reg[SNAP_PSW] & 0xFE) | parity);
+        rows[count++] = state;
+    }
+    return count;
+}
+
+int main(int argc, char **argv) {
+    long initial_baud = SERIAL_DEFAULT_BAUD;
+    long baud = 0;
+    long last = 0;
+    const char *raw_out = NULL, *raw_in = NULL;
+    uint8_t ring[TRACE_BLOCKS * TRACE_BLOCK_SIZE];
+    snapshot_t *rows;
+    long count = 0;
+    int blocks = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "i:b:o:n:f:")) != -1) {
+        if (opt == 'i')
+            initial_baud = strtol(optarg, NULL, 10);
+        else if (opt == 'b')
+            baud = strtol(optarg, NULL, 10);
+        else if (opt == 'o')
+            raw_out = optarg;
+        else if (opt == 'n')
+            last = strtol(optarg, NULL, 10);
+        else if (opt == 'f')
+            raw_in = optarg;
+        else
+            usage();
+    }
+
+    if (raw_in) {
+        FILE *in = fopen(raw_in, "rb");
+        size_t size;
+
+        if (argc != optind || !in) {
+            if (!in)
+                perror(raw_in);
+            usage();
+        }
+        size = fread(ring, 1, sizeof(ring), in);
+        fclose(in);
+        blocks = (int)(size / TRACE_BLOCK_SIZE);
+    } else {
+        int fd;
+
+        if (argc - optind != 1)
+            usage();
+        fd = serial_open(argv[optind], initial_baud);
+        if (fd < 0)
+            return 1;
+        if (baud && serial_negotiate_baud(fd, initial_baud, baud) < 0)
+            return 1;
+        serial_drain(fd, QUIET_MS);
+        if (receive_trace(fd, ring, &blocks) < 0)
+            return 1;
+        serial_drain(fd, QUIET_MS);
+        close(fd);
+        if (raw_out) {
+            FILE *out = fopen(raw_out, "wb");
+
+            if (!out || fwrite(ring, TRACE_BLOCK_SIZE, blocks, out) != (size_t)blocks) {
+                perror(raw_out);
+                return 1;
+            }
+            fclose(out);
+        }
+    }
+
+    // A block can hold at most one row per control byte
+    rows = malloc(sizeof(*rows) * blocks * TRACE_BLOCK_SIZE);
+    if (!rows) {
+        perror("trace_dump");
+        return 1;
+    }
+    for (int b = 0; b < blocks; b++)
+        count += decode_block(ring + b * TRACE_BLOCK_SIZE, rows + count, TRACE_BLOCK_SIZE);
+
+    snapshot_print_header(stdout, 0);
+    for (long r = (last > 0 && last < count) ? count - last : 0; r < count; r++)
+        snapshot_print(stdout, &rows[r]);
+    fprintf(stderr, "%ld steps in %d blocks\n", count, blocks);
+    free(rows);
+    return 0;
+}
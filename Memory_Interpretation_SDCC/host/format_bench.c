@@ -0,0 +1,463 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    format_bench.c
+ * @brief   Checks and times the editor's parsing and formatting on the host.
+ * @details code_memory.c, hex_format.c, command_line.c, crc.c and
+ *          request.c are compiled natively with the stand-in headers in
+ *          host/includes; this file supplies the UART, the memory spaces
+ *          and the console they expect. Every function is first checked
+ *          against known output, then timed, so a formatter change can be
+ *          judged without a board. request_mode() is checked with a
+ *          scripted pipelined session.
+ *          Numbers are host ns per call and only meaningful relative to
+ *          each other.
+ *
+ *          Usage: format_bench [-n iterations]
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+#include <at89c51ed2.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include "code_memory.h"
+#include "hex_format.h"
+#include "command_line.h"
+#include "crc.h"
+#include "frame.h"
+#include "memory_space.h"
+#include "request.h"
+#include "uart.h"
+#include "xram_memory.h"
+
+#define DEFAULT_ITERATIONS (200000UL)
+#define HOST_SPACE_SIZE (0x10000)
+#define CONSOLE_SIZE (256)
+#define SESSION_SIZE (128)
+#define REPLIES_MAX (16)
+
+static unsigned char code_space[HOST_SPACE_SIZE];
+static unsigned char xram_space[HOST_SPACE_SIZE];
+
+// Everything the firmware prints, kept only when a check wants to see it
+static char console[CONSOLE_SIZE];
+static size_t console_length;
+static int console_capture;
+static unsigned long console_sum;
+
+// Scripted input, replayed from the start when it runs out
+static const char *input_next;
+static const char *input_start;
+static const char *input_end;
+
+static int failures;
+
+
+static void usage(void);
+static double now_ns(void);
+static void console_reset(int capture);
+static void input_set(const char *text);
+static void input_bytes(const unsigned char *data, size_t length);
+static size_t request_build(unsigned char *out, unsigned char seq, unsigned char op,
+                            const unsigned char *payload, unsigned char len);
+static int reply_parse(unsigned char *seq, unsigned char *type, int *status, int max);
+static void check(int ok, const char *what);
+static void check_parse(const char *keys, unsigned int value, const char *echo);
+static void check_line(const char *keys, unsigned char count, unsigned int first, unsigned int last);
+static void check_request_mode(void);
+static void run_checks(void);
+static void report(const char *name, unsigned long count, double ns);
+static void run_benchmarks(unsigned long iterations);
+
+
+static void usage(void) {
+    fprintf(stderr, "usage: format_bench [-n iterations]\n");
+    exit(2);
+}
+
+static double now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+int host_putchar(int c) {
+    if (console_capture && console_length < CONSOLE_SIZE - 1)
+        console[console_length++] = (char)c;
+    console_sum += (unsigned char)c;
+    return c;
+}
+
+// Replays the script from the start once it runs out, so timing loops can
+// call parse_user_input() again without resetting it
+int host_getchar(void) {
+    if (input_next == input_end)
+        input_next = input_start;
+    return (unsigned char)*input_next++;
+}
+
+unsigned char *memory_pointer(unsigned char space, unsigned int address) {
+    return (space == 'X' ? xram_space : code_space) + (address & 0xFFFF);
+}
+
+unsigned char memory_space_select(unsigned char space) {
+    if (space == 'C' || space == 'c')
+        return MEMORY_SPACE_CODE;
+    if (space == 'X' || space == 'x')
+        return MEMORY_SPACE_XRAM;
+    return 0;
+}
+
+unsigned char parse_memory_space(void) {
+    return 0;
+}
+
+unsigned char memory_range_valid(unsigned char space, unsigned int start_address,
+                                 unsigned int end_address) {
+    return end_address >= start_address &&
+           (space != MEMORY_SPACE_XRAM || end_address <= XRAM_ADDRESS_MAX);
+}
+
+void xram_write(unsigned int address, unsigned char data) {
+    xram_space[address & 0xFFFF] = data;
+}
+
+void uart_write(const char *buffer, unsigned char length) {
+    while (length--)
+        host_putchar(*buffer++);
+}
+
+void uart_puts(const char *str) {
+    while (*str)
+        host_putchar(*str++);
+}
+
+// The scripted input has always arrived already
+unsigned char uart_wait_rx(unsigned int ticks) {
+    return input_next != input_end;
+}
+
+unsigned char uart_peek(void) {
+    return input_next != input_end ? (unsigned char)*input_next : 0;
+}
+
+static void console_reset(int capture) {
+    console_length = 0;
+    console[0] = '\0';
+    console_capture = capture;
+}
+
+static void input_set(const char *text) {
+    input_bytes((const unsigned char *)text, strlen(text));
+}
+
+static void input_bytes(const unsigned char *data, size_t length) {
+    input_start = input_next = (const char *)data;
+    input_end = input_start + length;
+}
+
+// Frames a request the way bt_pipe does
+static size_t request_build(unsigned char *out, unsigned char seq, unsigned char op,
+                            const unsigned char *payload, unsigned char len) {
+    unsigned int crc = CRC16_INIT;
+    size_t n = 0;
+    unsigned char i;
+
+    out[n++] = FRAME_SYNC;
+    out[n++] = seq;
+    out[n++] = op;
+    out[n++] = len;
+    for (i = 0; i < len; i++)
+        out[n++] = payload[i];
+    for (i = 1; i < n; i++)
+        crc = crc16_update(crc, out[i]);
+    out[n++] = (unsigned char)(crc >> 8);
+    out[n++] = (unsigned char)crc;
+    return n;
+}
+
+// Splits the captured console into reply frames; -1 on a malformed frame
+static int reply_parse(unsigned char *seq, unsigned char *type, int *status, int max) {
+    const unsigned char *c = (const unsigned char *)console;
+    size_t i = 0;
+    int count = 0;
+
+    while (i < console_length && count < max) {
+        unsigned int crc = CRC16_INIT;
+        size_t k, len;
+
+        if (console_length - i < 6 || c[i] != FRAME_SYNC)
+            return -1;
+        len = c[i + 3];
+        if (console_length - i < 6 + len)
+            return -1;
+        for (k = i + 1; k < i + 4 + len; k++)
+            crc = crc16_update(crc, c[k]);
+        if ((unsigned int)((c[k] << 8) | c[k + 1]) != (crc & 0xFFFF))
+            return -1;
+        seq[count] = c[i + 1];
+        type[count] = c[i + 2];
+        status[count] = (type[count] == REPLY_END && len) ? c[i + 4] : -1;
+        count++;
+        i += 6 + len;
+    }
+    return count;
+}
+
+static void check(int ok, const char *what) {
+    if (!ok) {
+        fprintf(stderr, "format_bench: FAIL %s\n", what);
+        failures++;
+    }
+}
+
+static void check_parse(const char *keys, unsigned int value, const char *echo) {
+    unsigned int result;
+
+    input_set(keys);
+    console_reset(1);
+    result = parse_user_input(16);
+    console[console_length] = '\0';
+    if (result != value || strcmp(console, echo) != 0) {
+        fprintf(stderr, "format_bench: FAIL parse_user_input: got %X \"%s\", expected %X \"%s\"\n",
+                result, console, value, echo);
+        failures++;
+    }
+}
+
+static void check_line(const char *keys, unsigned char count, unsigned int first, unsigned int last) {
+    unsigned int args[COMMAND_LINE_MAX_ARGS];
+    unsigned char result;
+
+    input_set(keys);
+    console_reset(1);
+    if (!command_line_pending()) {
+        fprintf(stderr, "format_bench: FAIL command_line_pending: \"%s\"\n", keys);
+        failures++;
+        return;
+    }
+    result = command_line_read(args);
+    if (result != count || console_length != 0 || input_next != input_end ||
+        (count != COMMAND_LINE_ERROR && count && (args[0] != first || args[count - 1] != last))) {
+        fprintf(stderr, "format_bench: FAIL command_line_read: \"%s\" gave %u\n", keys, result);
+        failures++;
+    }
+}
+
+/*
+ * A read, then a write whose length byte was corrupted in flight, with a
+ * checksum and a quit queued behind it. The parser takes the write's data
+ * for the CRC, rejects it and has to hunt through the rest of the data,
+ * which is full of ESC bytes; it must stay in Q mode and serve the
+ * requests behind it.
+ */
+static void check_request_mode(void) {
+    static const unsigned char read[] = { 'X', 0x01, 0x00, 0x01, 0x0F };
+    static const unsigned char write[] = { 0x01, 0x00, 0x1B, 0x1B, 0x41, 0x1B, 0x1B, 0x42, 0x1B, 0x1B };
+    static const unsigned char expected_seq[] = { 0, 1, 1, 2, 3, 4 };
+    static const unsigned char expected_type[] = { REPLY_HELLO, REPLY_DATA, REPLY_END,
+                                                   REPLY_END, REPLY_END, REPLY_END };
+    static const int expected_status[] = { -1, -1, REQUEST_OK, REQUEST_BAD_CRC,
+                                           REQUEST_OK, REQUEST_OK };
+    unsigned char session[SESSION_SIZE];
+    unsigned char seq[REPLIES_MAX], type[REPLIES_MAX];
+    int status[REPLIES_MAX];
+    unsigned char before = xram_space[0x0102];
+    size_t n = 0, corrupt;
+    int count, i, ok;
+
+    n += request_build(session + n, 1, REQUEST_READ, read, sizeof(read));
+    corrupt = n + 3;
+    n += request_build(session + n, 2, REQUEST_WRITE, write, sizeof(write));
+    session[corrupt] = 2;
+    n += request_build(session + n, 3, REQUEST_CRC, read, sizeof(read));
+    n += request_build(session + n, 4, REQUEST_QUIT, NULL, 0);
+
+    input_bytes(session, n);
+    console_reset(1);
+    request_mode();
+    count = reply_parse(seq, type, status, REPLIES_MAX);
+    ok = count == (int)sizeof(expected_seq) && input_next == input_end;
+    for (i = 0; ok && i < count; i++)
+        ok = seq[i] == expected_seq[i] && type[i] == expected_type[i] && status[i] == expected_status[i];
+    check(ok, "request_mode stays in Q mode after a corrupted request");
+    check(xram_space[0x0102] == before, "request_mode ignores a rejected write");
+    console_reset(0);
+}
+
+static void run_checks(void) {
+    static const char expected_row[] = "\r\n1230: 00  7F  A5  FF  ";
+    unsigned char data[4] = { 0x00, 0x7F, 0xA5, 0xFF };
+    char row[HEX_ROW_LENGTH];
+    unsigned char length;
+    int i;
+
+    for (i = 0; i < 16; i++) {
+        check(char_to_int((unsigned char)hex_digits[i]) == i, "char_to_int upper case");
+        check(int_to_char(i) == hex_digits[i], "int_to_char");
+    }
+    check(char_to_int('a') == 10 && char_to_int('f') == 15, "char_to_int lower case");
+    check(int_to_char(16) == '0' && int_to_char(-1) == '0', "int_to_char out of range");
+
+    length = format_hex_row(row, 0x1230, data, sizeof(data));
+    check(length == sizeof(expected_row) - 1 && memcmp(row, expected_row, length) == 0,
+          "format_hex_row");
+    length = format_hex_row(row, 0xFFF0, code_space, HEX_ROW_BYTES);
+    check(length == HEX_ROW_LENGTH, "format_hex_row full row length");
+
+    console_reset(1);
+    print_hex_number(0xBEEF, 4);
+    print_hex_number(0x12345678UL, 8);
+    print_hex_number(0xA, 1);
+    console[console_length] = '\0';
+    check(strcmp(console, "BEEF12345678A") == 0, "print_hex_number");
+
+    check_parse("1a2B\r", 0x1A2B, "1a2B");
+    check_parse("7\r", 0x7, "7");
+    check_parse("\r", 0, "");
+    check_parse("x1-23\r", 0x123, "123");
+    // A space after a digit ends the entry, one before it is skipped
+    check_parse(" 12 34\r", 0x12, "12");
+    // Digits past the fourth are dropped instead of overrunning or wrapping
+    check_parse("123456789\r", 0x1234, "1234");
+    check_parse("12\b3\r", 0x13, "12\b \b3");
+    check_parse("\b\b5\r", 0x5, "5");
+    check_parse("FFFF\b\bA\r", 0xFFA, "FFFF\b \b\b \bA");
+
+    check_line(" 1000 10FF\r", 2, 0x1000, 0x10FF);
+    check_line(" 0 7fff a5\r", 3, 0x0000, 0x00A5);
+    check_line("   4000   40FF  \r", 2, 0x4000, 0x40FF);
+    check_line(" \r", 0, 0, 0);
+    check_line(" 1 2 3 4\r", COMMAND_LINE_ERROR, 0, 0);
+    check_line(" 12345 0\r", COMMAND_LINE_ERROR, 0, 0);
+    check_line(" 1g 2\r", COMMAND_LINE_ERROR, 0, 0);
+    input_set("R 0 7FFF\r");
+    host_getchar();
+    check(command_line_pending(), "command_line_pending after a command key and space");
+    input_set("R0\r");
+    host_getchar();
+    check(!command_line_pending(), "command_line_pending for an interactive command");
+
+    console_reset(1);
+    hex_dump('C', 0x0000, 0x0000);
+    check(console_length == 8 + 4 + 2, "hex_dump single byte");
+    console_reset(1);
+    hex_dump('X', 0xFFF8, 0xFFFF);
+    check(console_length == 8 + 8 * 4 + 2, "hex_dump end of address space");
+    console_reset(0);
+
+    check_request_mode();
+}
+
+static void report(const char *name, unsigned long count, double ns) {
+    printf("%-34s %10lu  %10.1f ns\n", name, count, ns / count);
+}
+
+static void run_benchmarks(unsigned long iterations) {
+    char row[HEX_ROW_LENGTH];
+    unsigned long i, dumps = iterations / 1000 + 1;
+    volatile unsigned long sink = 0;
+    double start;
+
+    printf("%-34s %10s  %13s\n", "operation", "calls", "per call");
+
+    start = now_ns();
+    for (i = 0; i < iterations; i++)
+        sink += format_hex_row(row, (unsigned int)(i << 4), code_space + ((i << 4) & 0x7FF0), HEX_ROW_BYTES);
+    report("format_hex_row (16 bytes)", iterations, now_ns() - start);
+
+    start = now_ns();
+    for (i = 0; i < iterations; i++)
+        sink += format_hex_row(row, (unsigned int)(i << 4), code_space + ((i << 4) & 0x7FF0), 1);
+    report("format_hex_row (1 byte)", iterations, now_ns() - start);
+
+    start = now_ns();
+    for (i = 0; i < dumps; i++)
+        hex_dump('X', 0x0000, XRAM_ADDRESS_MAX);
+    report("hex_dump 0000-7FFF", dumps, now_ns() - start);
+    report("  per row", dumps * ((XRAM_ADDRESS_MAX + 1) / HEX_ROW_BYTES), now_ns() - start);
+
+    start = now_ns();
+    for (i = 0; i < iterations; i++)
+        print_hex_number((uint32_t)i, 4);
+    report("print_hex_number (4 digits)", iterations, now_ns() - start);
+
+    start = now_ns();
+    for (i = 0; i < iterations; i++)
+        print_hex_number((uint32_t)i * 2654435761UL, 8);
+    report("print_hex_number (8 digits)", iterations, now_ns() - start);
+
+    input_set("7fF0\r");
+    start = now_ns();
+    for (i = 0; i < iterations; i++)
+        sink += parse_user_input(16);
+    report("parse_user_input (4 digits)", iterations, now_ns() - start);
+
+    input_set("0123456789ABCDEF\r");
+    start = now_ns();
+    for (i = 0; i < iterations; i++)
+        sink += parse_user_input(16);
+    report("parse_user_input (16 keys)", iterations, now_ns() - start);
+
+    input_set(" 0000 7FFF\r");
+    start = now_ns();
+    for (i = 0; i < iterations; i++) {
+        unsigned int args[COMMAND_LINE_MAX_ARGS];
+
+        sink += command_line_read(args) + args[1];
+    }
+    report("command_line_read (R 0000 7FFF)", iterations, now_ns() - start);
+
+    start = now_ns();
+    for (i = 0; i < iterations; i++)
+        sink += char_to_int((unsigned char)hex_digits[i & 0x0F]) + (unsigned char)int_to_char((int)(i & 0x0F));
+    report("char_to_int + int_to_char", iterations, now_ns() - start);
+
+    (void)sink;
+}
+
+int main(int argc, char **argv) {
+    unsigned long iterations = DEFAULT_ITERATIONS;
+    unsigned long i;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:")) != -1) {
+        if (opt == 'n')
+            iterations = strtoul(optarg, NULL, 10);
+        else
+            usage();
+    }
+    if (optind != argc || iterations == 0)
+        usage();
+
+    // Deterministic pseudo-random contents for both spaces
+    for (i = 0; i < HOST_SPACE_SIZE; i++) {
+        code_space[i] = (unsigned char)(i * 131 + (i >> 8));
+        xram_space[i] = (unsigned char)(i * 197 + 0x5A);
+    }
+
+    run_checks();
+    if (failures) {
+        fprintf(stderr, "format_bench: %d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("format_bench: all checks passed\n");
+    run_benchmarks(iterations);
+    return 0;
+}
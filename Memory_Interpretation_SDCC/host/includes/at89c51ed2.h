@@ -0,0 +1,35 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    at89c51ed2.h
+ * @brief   Stand-in for the SDCC register header when building with gcc.
+ * @details Only the pure parsing and formatting sources are compiled on the
+ *          host; they need the SDCC storage qualifiers to vanish and nothing
+ *          from the SFR map.
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+
+#ifndef _host_at89c51ed2_H_
+#define _host_at89c51ed2_H_
+
+#define __code
+#define __xdata
+#define __data
+#define __idata
+#define __bit unsigned char
+#define __interrupt(n)
+#define __at(n)
+
+#endif
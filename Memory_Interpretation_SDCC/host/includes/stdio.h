@@ -0,0 +1,36 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    stdio.h
+ * @brief   Routes the firmware's console I/O to the host bench.
+ * @details On the board putchar() and getchar() go to the UART; here they
+ *          go to host_putchar() and host_getchar(), which the bench provides.
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+
+#ifndef _host_stdio_H_
+#define _host_stdio_H_
+
+#include_next <stdio.h>
+
+int host_putchar(int c);
+int host_getchar(void);
+
+#undef putchar
+#undef getchar
+#define putchar(c) host_putchar(c)
+#define getchar() host_getchar()
+
+#endif
@@ -24,32 +24,32 @@
 #include <stdint.h>
 #include "code_memory.h"
 #include "xram_memory.h"
-#define MAX_DIGITS 5
+#include "memory_space.h"
+#include "hex_format.h"
+#include "uart.h"
+#define MAX_DIGITS 4
 #define CARRIAGE_RETURN 13
 #define BACKSPACE 8
 #define SPACE 32
 
 #define ENTER_KEY (13)
-#define DIVIDE_BY_16 (16)
 #define ASCII_SPACE (32)
 #define NUMBER_BASE (16)
 #define DATA_MAX (255)
 #define ADDRESS_MAX (0x7FFF)
-#define CODE_START_ADDRESS (0x0000)
 
 char int_to_char(int num);
 unsigned char char_to_int(unsigned char ch);
 unsigned int parse_user_input(unsigned char base);
 void read_code_memory(void);
+void read_code_memory_range(unsigned int start_address, unsigned int end_address);
 void code_memory_read(unsigned int start_address, unsigned int end_address);
 void print_hex_number(uint32_t num, unsigned char width);
 
 
 char int_to_char(int num) {
-    if (num >= 0 && num <= 9)
-        return '0' + num;
-    else if (num >= 10 && num <= 15)
-        return 'A' + (num - 10);
+    if (num >= 0 && num <= 15)
+        return hex_digits[num];
     return '0';
 }
 
@@ -65,104 +65,71 @@ unsigned char char_to_int(unsigned char ch) {
 
 unsigned int parse_user_input(unsigned char base) {
     unsigned int number = 0;
-    unsigned int digits[MAX_DIGITS] = {0};
-    unsigned int digit_count = 0;
+    unsigned char digit_count = 0;
     unsigned char current_char = 0;
 
+    // Digits are shifted in as they arrive; past MAX_DIGITS they are
+    // ignored and not echoed, so the value cannot wrap silently. A space
+    // after a digit also ends the entry, so "1000 10FF" typed after a
+    // command key answers two prompts.
     while (current_char != CARRIAGE_RETURN) {
         current_char = getchar();
-        if (((current_char >= '0') && (current_char <= '9')) ||
+        if (current_char == SPACE && digit_count > 0) {
+            break;
+        } else if (((current_char >= '0') && (current_char <= '9')) ||
             ((current_char >= 'a') && (current_char <= 'f')) ||
             ((current_char >= 'A') && (current_char <= 'F'))) {
-            putchar(current_char);
-            digits[digit_count++] = char_to_int(current_char);
+            if (digit_count < MAX_DIGITS) {
+                putchar(current_char);
+                number = number * base + char_to_int(current_char);
+                digit_count++;
+            }
         } else if (current_char == BACKSPACE && digit_count > 0) {
             putchar(BACKSPACE);
             putchar(SPACE);
             putchar(BACKSPACE);
+            number /= base;
             digit_count--;
         }
     }
-
-    for (unsigned int i = 0; i < digit_count; i++) {
-        number = number * base + digits[i];
-    }
     return number;
 }
 
 void print_hex_number(uint32_t num, unsigned char width) {
-    unsigned char buffer[10];
-    int8_t digit_count = 0;
-    do {
-        buffer[digit_count++] = int_to_char(num % 16);
-        num /= 16;
-    } while (num > 0);
-
-    while (digit_count < width) {
-        putchar('0');
-        width--;
-    }
-
-    for (int i = digit_count - 1; i >= 0; i--) {
-        putchar(buffer[i]);
+    // Shift out one nibble per digit, most significant first
+    while (width--) {
+        putchar(hex_digits[(unsigned char)(num >> (width << 2)) & 0x0F]);
     }
 }
+
 void read_code_memory(void) {
     unsigned int start_address;
     unsigned int end_address;
 
-    printf("\r\n Enter Start Address (Code Memory): ");
+    uart_puts("\r\n Enter Start Address (Code Memory): ");
      //printf("\r\n");
     start_address = parse_user_input(NUMBER_BASE);
-     printf("\r\n");
-    if (start_address < CODE_START_ADDRESS) {
-        printf("\r\n Invalid Code Memory Start Address. Must be >= 0x0000.\r\n");
-        return;
-    }
+     uart_puts("\r\n");
 
-    printf("\r\n Enter End Address (Code Memory): ");
+    uart_puts("\r\n Enter End Address (Code Memory): ");
      //printf("\r\n");
     end_address = parse_user_input(NUMBER_BASE);
-     printf("\r\n");
-    if (end_address < CODE_START_ADDRESS) {
-        printf("\r\n Invalid Code Memory End Address. Must be >= 0x0000.\r\n");
+     uart_puts("\r\n");
+    read_code_memory_range(start_address, end_address);
+}
+
+void read_code_memory_range(unsigned int start_address, unsigned int end_address) {
+    if (end_address < start_address) {
+        uart_puts("\r\n Error: End Address must be greater than or equal to Start Address.\r\n");
         return;
     }
-    printf("\r\n-----------------------CODE MEMORY CONTENTS----------------------\r\n");
-    printf("\r\n");
-    printf("Addr: +0  +1  +2  +3  +4  +5  +6  +7  +8  +9  +A  +B  +C  +D  +E  +F\r\n");
+    uart_puts("\r\n-----------------------CODE MEMORY CONTENTS----------------------\r\n");
+    uart_puts("\r\n");
+    uart_puts("Addr: +0  +1  +2  +3  +4  +5  +6  +7  +8  +9  +A  +B  +C  +D  +E  +F\r\n");
     code_memory_read(start_address, end_address);
-    printf("\r\n-------------------------------------------------------------------\r\n");
-
-    
+    uart_puts("\r\n-------------------------------------------------------------------\r\n");
 }
 
 void code_memory_read(unsigned int start_address, unsigned int end_address) {
-    unsigned char count = 0;
-    unsigned char __code *ptr;
-
-    for (unsigned int addr = start_address; addr <= end_address; addr++) {
-        ptr = (unsigned char __code *)addr;
-
-        // Start a new row for every 16 addresses
-        if (count % DIVIDE_BY_16 == 0) {
-            putchar('\n');
-            putchar('\r');
-
-            print_hex_number(addr, 4);
-            printf(": ");
-        }
-
-        // Print the code memory content
-        print_hex_number(*ptr, 2);
-        printf("  "); // Add spacing between numbers
-
-        count++;
-    }
-
-    
-       
-        printf("\r\n");
-    
+    hex_dump(MEMORY_SPACE_CODE, start_address, end_address);
 }
-  
\ No newline at end of file
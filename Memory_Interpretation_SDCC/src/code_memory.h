@@ -20,7 +20,7 @@
 
 
 #ifndef _code_memory_H_
-#define _code_memorT_H_
+#define _code_memory_H_
 
 /**
  * @brief   Reads and displays code memory content within a specified range.
@@ -29,6 +29,15 @@
  */
 void read_code_memory(void);
 
+/**
+ * @brief   Displays code memory from start to end address with the table
+ *          header, after checking the range.
+ * @param   start_address - The starting address in code memory.
+ * @param   end_address - The ending address in code memory.
+ * @return  None
+ */
+void read_code_memory_range(unsigned int start_address, unsigned int end_address);
+
 /**
  * @brief   Reads code memory data from the specified start to end address.
  * @param   start_address - The starting address in code memory.
@@ -46,6 +55,8 @@ unsigned int parse_user_input(unsigned char base);
 
 /**
  * @brief   Prints a hexadecimal representation of a number with a specified width.
+ * @details Uses the shared nibble lookup table; digits beyond width are
+ *          not printed.
  * @param   num - The number to be printed.
  * @param   width - The number of hexadecimal digits to display.
  * @return  None
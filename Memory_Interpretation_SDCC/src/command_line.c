@@ -0,0 +1,75 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    command_line.c
+ * @brief   Implements the one-line command form.
+ * @details "R 1000 10FF", "W 0 7FFF A5" or "C 4000 40FF" reach the target
+ *          in one packet, so the command costs a single Bluetooth round
+ *          trip instead of one per prompt. The line is parsed straight out
+ *          of the RX ring and nothing is echoed.
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+#include <at89c51ed2.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "command_line.h"
+#include "code_memory.h"
+#include "uart.h"
+
+#define CARRIAGE_RETURN (13)
+#define SPACE (32)
+#define NUMBER_BASE (16)
+#define ARG_MAX_DIGITS (4)
+// 10 ms: several byte times at 9600 baud, short enough not to be noticed
+// after a key typed alone
+#define LINE_WAIT_TICKS (2)
+
+
+unsigned char command_line_pending(void) {
+    if (!uart_wait_rx(LINE_WAIT_TICKS))
+        return 0;
+    if (uart_peek() != SPACE)
+        return 0;
+    return 1;
+}
+
+unsigned char command_line_read(unsigned int *args) {
+    unsigned char count = 0;
+    unsigned char digits = 0;
+    unsigned char error = 0;
+    unsigned char c;
+
+    while ((c = getchar()) != CARRIAGE_RETURN) {
+        if (c == SPACE) {
+            digits = 0;
+        } else if (((c >= '0') && (c <= '9')) ||
+                   ((c >= 'a') && (c <= 'f')) ||
+                   ((c >= 'A') && (c <= 'F'))) {
+            if (digits == 0) {
+                if (count == COMMAND_LINE_MAX_ARGS) {
+                    error = 1;
+                    continue;
+                }
+                args[count++] = 0;
+            }
+            if (++digits > ARG_MAX_DIGITS)
+                error = 1;
+            args[count - 1] = args[count - 1] * NUMBER_BASE + char_to_int(c);
+        } else {
+            error = 1;
+        }
+    }
+    return error ? COMMAND_LINE_ERROR : count;
+}
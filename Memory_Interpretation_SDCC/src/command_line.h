@@ -0,0 +1,49 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    command_line.h
+ * @brief   Header file for the one-line command form.
+ * @details Declares the reader for commands sent as a single line, such as
+ *          "R 1000 10FF", instead of answering one prompt per argument.
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+
+#ifndef _command_line_H_
+#define _command_line_H_
+
+#define COMMAND_LINE_MAX_ARGS (3)
+#define COMMAND_LINE_ERROR (0xFF)
+
+/**
+ * @brief   Tells whether the command key arrived as the start of a line.
+ * @details True when a space follows the key within a few byte times, as
+ *          it does when the host sends the whole line at once. Otherwise
+ *          the command falls back to its interactive prompts.
+ * @param   None
+ * @return  1 for a one-line command, 0 for an interactive one.
+ */
+unsigned char command_line_pending(void);
+
+/**
+ * @brief   Reads the rest of the line and parses its hexadecimal arguments.
+ * @details Arguments are separated by spaces and have at most 4 digits.
+ *          The line is consumed up to the carriage return even on an error.
+ * @param   args - Receives up to COMMAND_LINE_MAX_ARGS values.
+ * @return  Number of arguments, or COMMAND_LINE_ERROR on a bad character,
+ *          an overlong argument or too many arguments.
+ */
+unsigned char command_line_read(unsigned int *args);
+
+#endif
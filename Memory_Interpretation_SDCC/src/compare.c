@@ -0,0 +1,148 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    compare.c
+ * @brief   Implements the range compare command.
+ * @details Both ranges are walked on the target and only the runs that
+ *          differ are sent, one line per run of up to 16 bytes:
+ *
+ *              A:addr B:addr +len  a-bytes | b-bytes
+ *
+ *          Identical ranges cost a single summary line.
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+#include <at89c51ed2.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "code_memory.h"
+#include "memory_space.h"
+#include "compare.h"
+#include "hex_format.h"
+#include "uart.h"
+
+#define NUMBER_BASE (16)
+
+
+static void print_run(unsigned char space_a, unsigned int address_a,
+                      unsigned char space_b, unsigned int address_b,
+                      unsigned char length);
+
+
+static void print_run(unsigned char space_a, unsigned int address_a,
+                      unsigned char space_b, unsigned int address_b,
+                      unsigned char length) {
+    unsigned char *ptr_a = memory_pointer(space_a, address_a);
+    unsigned char *ptr_b = memory_pointer(space_b, address_b);
+    unsigned char i;
+
+    uart_puts("\r\n ");
+    putchar(space_a);
+    putchar(':');
+    print_hex_word(address_a);
+    putchar(' ');
+    putchar(space_b);
+    putchar(':');
+    print_hex_word(address_b);
+    uart_puts(" +");
+    print_hex_byte(length);
+    putchar(' ');
+    for (i = 0; i < length; i++) {
+        putchar(' ');
+        print_hex_byte(ptr_a[i]);
+    }
+    uart_puts(" |");
+    for (i = 0; i < length; i++) {
+        putchar(' ');
+        print_hex_byte(ptr_b[i]);
+    }
+}
+
+unsigned int memory_compare(unsigned char space_a, unsigned int address_a,
+                            unsigned char space_b, unsigned int address_b,
+                            unsigned int length) {
+    unsigned char *ptr_a = memory_pointer(space_a, address_a);
+    unsigned char *ptr_b = memory_pointer(space_b, address_b);
+    unsigned int run_a = 0, run_b = 0;
+    unsigned char run_length = 0;
+    unsigned int differences = 0;
+
+    do {
+        if (*ptr_a != *ptr_b) {
+            if (run_length == 0) {
+                run_a = address_a;
+                run_b = address_b;
+            }
+            differences++;
+            if (++run_length == COMPARE_RUN_MAX) {
+                print_run(space_a, run_a, space_b, run_b, run_length);
+                run_length = 0;
+            }
+        } else if (run_length) {
+            print_run(space_a, run_a, space_b, run_b, run_length);
+            run_length = 0;
+        }
+        ptr_a++;
+        ptr_b++;
+        address_a++;
+        address_b++;
+    } while (--length);
+
+    if (run_length)
+        print_run(space_a, run_a, space_b, run_b, run_length);
+    return differences;
+}
+
+void compare_memory(void) {
+    unsigned char space_a, space_b;
+    unsigned int start_a, end_a, start_b;
+    unsigned int length, differences;
+
+    uart_puts("\r\n First Range:");
+    space_a = parse_memory_space();
+    if (!space_a)
+        return;
+    uart_puts("\r\n Enter Start Address (Hex): ");
+    start_a = parse_user_input(NUMBER_BASE);
+    uart_puts("\r\n");
+    uart_puts("\r\n Enter End Address (Hex): ");
+    end_a = parse_user_input(NUMBER_BASE);
+    uart_puts("\r\n");
+    if (!memory_range_valid(space_a, start_a, end_a)) {
+        uart_puts("\r\n Error: Invalid address range.\r\n");
+        return;
+    }
+
+    uart_puts("\r\n Second Range:");
+    space_b = parse_memory_space();
+    if (!space_b)
+        return;
+    uart_puts("\r\n Enter Start Address (Hex): ");
+    start_b = parse_user_input(NUMBER_BASE);
+    uart_puts("\r\n");
+    length = end_a - start_a + 1;
+    if (!memory_range_valid(space_b, start_b, start_b + (length - 1)) ||
+        start_b + (length - 1) < start_b) {
+        uart_puts("\r\n Error: Second range exceeds memory.\r\n");
+        return;
+    }
+
+    differences = memory_compare(space_a, start_a, space_b, start_b, length);
+    if (differences) {
+        uart_puts("\r\n\r\n 0x");
+        print_hex_word(differences);
+        uart_puts(" byte(s) differ.\r\n");
+    } else
+        uart_puts("\r\n Ranges are identical.\r\n");
+}
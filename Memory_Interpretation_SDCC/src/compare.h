@@ -0,0 +1,47 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    compare.h
+ * @brief   Header file for the range compare command.
+ * @details Declares the on-target comparison of two code/XRAM ranges.
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+
+#ifndef _compare_H_
+#define _compare_H_
+
+#define COMPARE_RUN_MAX (16)
+
+/**
+ * @brief   Compares two ranges and prints only the differing runs.
+ * @param   space_a - Space of the first range.
+ * @param   address_a - First address of the first range.
+ * @param   space_b - Space of the second range.
+ * @param   address_b - First address of the second range.
+ * @param   length - Number of bytes to compare (0 means 65536).
+ * @return  Number of differing bytes.
+ */
+unsigned int memory_compare(unsigned char space_a, unsigned int address_a,
+                            unsigned char space_b, unsigned int address_b,
+                            unsigned int length);
+
+/**
+ * @brief   Prompts for two ranges and reports their differences.
+ * @param   None
+ * @return  None
+ */
+void compare_memory(void);
+
+#endif
@@ -0,0 +1,66 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    crc.h
+ * @brief   Header file for the table-driven checksum routines.
+ * @details CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF, no reflection),
+ *          used to protect binary frames and for range checksums, and the
+ *          standard reflected CRC-32 (poly 0xEDB88320, as used by zlib).
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+
+#ifndef _crc_H_
+#define _crc_H_
+
+#define CRC16_INIT (0xFFFF)
+#define CRC32_INIT (0xFFFFFFFFUL)
+#define CRC32_FINAL_XOR (0xFFFFFFFFUL)
+
+/**
+ * @brief   Feeds one byte into a running CRC-16.
+ * @param   crc - The CRC accumulated so far (start with CRC16_INIT).
+ * @param   data - The next data byte.
+ * @return  The updated CRC.
+ */
+unsigned int crc16_update(unsigned int crc, unsigned char data);
+
+/**
+ * @brief   Feeds one byte into a running CRC-32.
+ * @param   crc - The CRC accumulated so far (start with CRC32_INIT).
+ * @param   data - The next data byte.
+ * @return  The updated CRC; XOR with CRC32_FINAL_XOR when done.
+ */
+unsigned long crc32_update(unsigned long crc, unsigned char data);
+
+/**
+ * @brief   Computes the CRC-16 and CRC-32 of a code or XRAM range.
+ * @param   space - MEMORY_SPACE_CODE or MEMORY_SPACE_XRAM.
+ * @param   start_address - First address of the range.
+ * @param   end_address - Last address of the range (inclusive).
+ * @param   crc16_out - Receives the CRC-16/CCITT-FALSE.
+ * @param   crc32_out - Receives the finished CRC-32.
+ * @return  None
+ */
+void memory_checksum(unsigned char space, unsigned int start_address, unsigned int end_address,
+                     unsigned int *crc16_out, unsigned long *crc32_out);
+
+/**
+ * @brief   Prompts for a memory range and prints its CRC-16 and CRC-32.
+ * @param   None
+ * @return  None
+ */
+void checksum_memory(void);
+
+#endif
@@ -0,0 +1,54 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    frame.h
+ * @brief   Header file for the binary framed dump protocol.
+ * @details After the 'B' command the host sends a 5-byte raw request:
+ *
+ *              space ('C' or 'X'), start (hi, lo), end (hi, lo)
+ *
+ *          The editor answers with a stream of frames:
+ *
+ *              0x7E, seq, len, payload[len], crc16 (hi, lo)
+ *
+ *          seq counts up from 0 and wraps at 256, len is at most 64, and
+ *          the CRC-16 covers seq, len and the payload. A frame with len 0
+ *          ends the stream; an invalid request gets only that frame.
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+
+#ifndef _frame_H_
+#define _frame_H_
+
+#define FRAME_SYNC (0x7E)
+#define FRAME_PAYLOAD_MAX (64)
+
+/**
+ * @brief   Sends one frame with the given payload.
+ * @param   seq - Sequence number of the frame.
+ * @param   data - Generic pointer to the payload (code or XRAM).
+ * @param   len - Payload length, at most FRAME_PAYLOAD_MAX.
+ * @return  None
+ */
+void frame_send(unsigned char seq, unsigned char *data, unsigned char len);
+
+/**
+ * @brief   Reads a binary dump request and streams the range as frames.
+ * @param   None
+ * @return  None
+ */
+void binary_dump(void);
+
+#endif
@@ -0,0 +1,90 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    hex_format.c
+ * @brief   Implements the printf-free hexadecimal formatter.
+ * @details A 16-entry lookup table replaces SDCC's printf("%02X") (which
+ *          links printf_large/vprintf) and the divide/modulo per nibble of
+ *          the old print_hex_number(). A 16-byte row costs a few hundred
+ *          machine cycles to build instead of one vprintf() format parse
+ *          per byte, and it is queued for the UART in one call.
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+#include <at89c51ed2.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "hex_format.h"
+#include "memory_space.h"
+#include "uart.h"
+
+__code const char hex_digits[16] = {
+    '0', '1', '2', '3', '4', '5', '6', '7',
+    '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'
+};
+
+static __xdata char row_buffer[HEX_ROW_LENGTH];
+
+
+unsigned char format_hex_row(char __xdata *buffer, unsigned int address,
+                             unsigned char *data, unsigned char count) {
+    char __xdata *out = buffer;
+    unsigned char value;
+
+    *out++ = '\r';
+    *out++ = '\n';
+    *out++ = hex_digits[(address >> 12) & 0x0F];
+    *out++ = hex_digits[(address >> 8) & 0x0F];
+    *out++ = hex_digits[(address >> 4) & 0x0F];
+    *out++ = hex_digits[address & 0x0F];
+    *out++ = ':';
+    *out++ = ' ';
+
+    while (count--) {
+        value = *data++;
+        *out++ = hex_digits[value >> 4];
+        *out++ = hex_digits[value & 0x0F];
+        *out++ = ' ';
+        *out++ = ' ';
+    }
+    return out - buffer;
+}
+
+void hex_dump(unsigned char space, unsigned int start_address, unsigned int end_address) {
+    unsigned char *ptr = memory_pointer(space, start_address);
+    unsigned int remaining;
+    unsigned char count;
+
+    while (1) {
+        // remaining is one less than the bytes left, so 0x0000-0xFFFF fits
+        remaining = end_address - start_address;
+        count = (remaining >= HEX_ROW_BYTES - 1) ? HEX_ROW_BYTES : remaining + 1;
+        uart_write(row_buffer, format_hex_row(row_buffer, start_address, ptr, count));
+        if (remaining < HEX_ROW_BYTES)
+            break;
+        start_address += HEX_ROW_BYTES;
+        ptr += HEX_ROW_BYTES;
+    }
+    uart_puts("\r\n");
+}
+
+void print_hex_byte(unsigned char value) {
+    putchar(hex_digits[value >> 4]);
+    putchar(hex_digits[value & 0x0F]);
+}
+
+void print_hex_word(unsigned int value) {
+    print_hex_byte(value >> 8);
+    print_hex_byte(value & 0xFF);
+}
@@ -0,0 +1,68 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    hex_format.h
+ * @brief   Header file for the printf-free hexadecimal formatter.
+ * @details Declares the nibble-lookup helpers shared by every dump and
+ *          report path of the memory editor.
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+
+#ifndef _hex_format_H_
+#define _hex_format_H_
+
+#define HEX_ROW_BYTES (16)
+// "\r\nAAAA: " plus "XX  " per byte
+#define HEX_ROW_LENGTH (8 + HEX_ROW_BYTES * 4)
+
+extern __code const char hex_digits[16];
+
+/**
+ * @brief   Renders one dump row ("\r\nAAAA: XX  XX  ...") into a buffer.
+ * @param   buffer - Output buffer of at least HEX_ROW_LENGTH characters.
+ * @param   address - Address printed at the start of the row.
+ * @param   data - Generic pointer to the row's bytes.
+ * @param   count - Number of bytes in the row, 1 to HEX_ROW_BYTES.
+ * @return  Number of characters written.
+ */
+unsigned char format_hex_row(char __xdata *buffer, unsigned int address,
+                             unsigned char *data, unsigned char count);
+
+/**
+ * @brief   Dumps a code or XRAM range as rows of 16 bytes.
+ * @details Each row is formatted into a buffer and queued with a single
+ *          uart_write() call.
+ * @param   space - MEMORY_SPACE_CODE or MEMORY_SPACE_XRAM.
+ * @param   start_address - First address to dump.
+ * @param   end_address - Last address to dump (inclusive).
+ * @return  None
+ */
+void hex_dump(unsigned char space, unsigned int start_address, unsigned int end_address);
+
+/**
+ * @brief   Prints a byte as two hexadecimal digits.
+ * @param   value - The byte to print.
+ * @return  None
+ */
+void print_hex_byte(unsigned char value);
+
+/**
+ * @brief   Prints a 16-bit value as four hexadecimal digits.
+ * @param   value - The value to print.
+ * @return  None
+ */
+void print_hex_word(unsigned int value);
+
+#endif
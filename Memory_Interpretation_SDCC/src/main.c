@@ -24,65 +24,106 @@
 #include <stdint.h>
 #include "code_memory.h"
 #include "xram_memory.h"
+#include "uart.h"
+#include "frame.h"
+#include "crc.h"
+#include "search.h"
+#include "compare.h"
+#include "command_line.h"
+#include "request.h"
+
+#define DATA_MAX (255)
 
 // Function Prototypes
 void display_help(void);
-int getchar(void);
-int putchar(int c);
-void uart_initialization(void);
 void handle_command(void);
+void handle_command_line(char cmd);
 
 void display_help(void) {
-    printf("\r\n========================================\r\n");
-    printf("\r\n");
-    printf("         MEMORY EDITOR \r\n");
-    printf("\r\n");
-    printf("============================================\r\n");
-    printf("\r\n");
-    printf(" Available Commands:\r\n");
-    printf("\r\n");
-    printf("< R >  Read Data Memory\r\n");
-    printf("\r\n");
-    printf("< W >  Write Data Memory\r\n");
-    printf("\r\n");
-    printf("< C >  Read Code Memory\r\n");
-    printf("\r\n");
-    printf("< H >  Display This Help Menu\r\n");
-    printf("\r\n");
-    printf("< X >  Exit \r\n");
-    printf("\r\n");
-    printf("===========================================\r\n");
-}
-
-int getchar(void) {
-    while (!RI);
-    RI = 0;
-    return SBUF;
+    uart_puts("\r\n========================================\r\n");
+    uart_puts("\r\n");
+    uart_puts("         MEMORY EDITOR \r\n");
+    uart_puts("\r\n");
+    uart_puts("============================================\r\n");
+    uart_puts("\r\n");
+    uart_puts(" Available Commands:\r\n");
+    uart_puts("\r\n");
+    uart_puts("< R >  Read Data Memory\r\n");
+    uart_puts("\r\n");
+    uart_puts("< W >  Write Data Memory\r\n");
+    uart_puts("\r\n");
+    uart_puts("< C >  Read Code Memory\r\n");
+    uart_puts("\r\n");
+    uart_puts("< M >  Move/Copy Block to Data Memory\r\n");
+    uart_puts("\r\n");
+    uart_puts("< S >  Search Memory for a Byte Pattern\r\n");
+    uart_puts("\r\n");
+    uart_puts("< D >  Compare Two Ranges (Differences Only)\r\n");
+    uart_puts("\r\n");
+    uart_puts("< K >  Checksum (CRC16/CRC32) of a Range\r\n");
+    uart_puts("\r\n");
+    uart_puts("< B >  Binary Dump (host tool)\r\n");
+    uart_puts("\r\n");
+    uart_puts("< Q >  Pipelined Requests (host tool, ESC to leave)\r\n");
+    uart_puts("\r\n");
+    uart_puts("< U >  Change UART Baud Rate\r\n");
+    uart_puts("\r\n");
+    uart_puts("< H >  Display This Help Menu\r\n");
+    uart_puts("\r\n");
+    uart_puts("< X >  Exit \r\n");
+    uart_puts("\r\n");
+    uart_puts(" R, W and C also take their arguments on one line:\r\n");
+    uart_puts("   R 1000 10FF   W 0 7FFF A5   C 4000 40FF\r\n");
+    uart_puts("\r\n");
+    uart_puts("===========================================\r\n");
 }
 
-int putchar(int c) {
-    while (!TI);
-    SBUF = c;
-    TI = 0;
-    return c;
-}
+/*
+ * One-line form: the whole command arrives in one packet, so it costs a
+ * single Bluetooth round trip instead of one per prompt. W does not echo.
+ */
+void handle_command_line(char cmd) {
+    unsigned int args[COMMAND_LINE_MAX_ARGS];
+    unsigned char count = command_line_read(args);
 
-void uart_initialization(void) {
-    TMOD |= 0x20;
-    SCON = 0x50;
-    TH1 = 0xFD;
-    TR1 = 1;
-    ES = 1;
-    EA = 1;
-    TI = 1;
+    switch (cmd) {
+        case 'R':
+        case 'r':
+            if (count == 2) {
+                read_memory_range(args[0], args[1]);
+                return;
+            }
+            break;
+        case 'W':
+        case 'w':
+            if (count == 3 && args[2] <= DATA_MAX) {
+                write_memory_range(args[0], args[1], args[2], 0);
+                return;
+            }
+            break;
+        case 'C':
+        case 'c':
+            if (count == 2) {
+                read_code_memory_range(args[0], args[1]);
+                return;
+            }
+            break;
+    }
+    uart_puts("\r\n Invalid Command Line. Use R start end, W start end data or C start end.\r\n");
 }
 
 void handle_command(void) {
     char cmd;
-    printf("\r\nEnter Command (H for help): ");
+    uart_puts("\r\nEnter Command (H for help): ");
     cmd = getchar();
     putchar(cmd);
-    printf("\r\n");
+    uart_puts("\r\n");
+
+    if (command_line_pending()) {
+        handle_command_line(cmd);
+        uart_puts("\r\n ******************************************************\r\n");
+        return;
+    }
 
     switch (cmd) {
         case 'R':
@@ -97,14 +138,43 @@ void handle_command(void) {
         case 'c':
             read_code_memory();
             break;
+        case 'M':
+        case 'm':
+            move_memory();
+            break;
+        case 'S':
+        case 's':
+            search_memory();
+            break;
+        case 'D':
+        case 'd':
+            compare_memory();
+            break;
+        case 'K':
+        case 'k':
+            checksum_memory();
+            break;
+        case 'B':
+        case 'b':
+            binary_dump();
+            break;
+        case 'Q':
+        case 'q':
+            request_mode();
+            break;
+        case 'U':
+        case 'u':
+            change_baud_rate();
+            break;
         case 'H':
         case 'h':
             display_help();
             break;
         case 'X':
         case 'x': {
-             printf("\033[2J\033[H"); // Clear screen and reset cursor position
-            printf("\r\nExiting to 0x0000...\r\n");
+             uart_puts("\033[2J\033[H"); // Clear screen and reset cursor position
+            uart_puts("\r\nExiting to 0x0000...\r\n");
+            uart_release(); // The monitor at 0x0000 drives the UART by polling
 
             // Reset to 0x0000
             void (*reset_to_0x0000)(void) = (void (*)(void))0x0000;
@@ -112,18 +182,19 @@ void handle_command(void) {
             break;
         }
         default:
-            printf("\r\n Invalid Command. Press 'H' for help.\r\n");
+            uart_puts("\r\n Invalid Command. Press 'H' for help.\r\n");
             break;
     }
-    printf("\r\n ******************************************************\r\n");
+    uart_puts("\r\n ******************************************************\r\n");
 }
 
 
 void main(void) {
+    // Fill XRAM first: the UART rings live there and must not be wiped later
+    initialize_xram();
     uart_initialization();
     display_help();
-    initialize_xram();
-    
+
 
     while (1) {
         handle_command();
@@ -0,0 +1,65 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    memory_space.c
+ * @brief   Implements address space selection for code memory and XRAM.
+ * @details SDCC generic pointers carry a tag byte for the space they point
+ *          into, so one read loop can walk either code memory (MOVC) or
+ *          XRAM (MOVX) depending on how the pointer was built.
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+#include <at89c51ed2.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "memory_space.h"
+#include "uart.h"
+
+
+unsigned char memory_space_select(unsigned char space) {
+    if (space == 'C' || space == 'c')
+        return MEMORY_SPACE_CODE;
+    else if (space == 'X' || space == 'x')
+        return MEMORY_SPACE_XRAM;
+    return 0;
+}
+
+unsigned char parse_memory_space(void) {
+    unsigned char space;
+
+    uart_puts("\r\n Memory Space (C = Code, X = XRAM): ");
+    space = getchar();
+    putchar(space);
+    uart_puts("\r\n");
+    space = memory_space_select(space);
+    if (!space) {
+        uart_puts("\r\n Invalid Memory Space.\r\n");
+    }
+    return space;
+}
+
+unsigned char memory_range_valid(unsigned char space, unsigned int start_address,
+                                 unsigned int end_address) {
+    if (end_address < start_address)
+        return 0;
+    if (space == MEMORY_SPACE_XRAM && end_address > XRAM_ADDRESS_MAX)
+        return 0;
+    return 1;
+}
+
+unsigned char *memory_pointer(unsigned char space, unsigned int address) {
+    if (space == MEMORY_SPACE_CODE)
+        return (unsigned char __code *)address;
+    return (unsigned char __xdata *)address;
+}
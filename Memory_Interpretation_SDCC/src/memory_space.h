@@ -0,0 +1,65 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    memory_space.h
+ * @brief   Header file for selecting between code memory and XRAM.
+ * @details Commands that work on either address space take a one-letter
+ *          space selector and read through a generic pointer built here.
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+
+#ifndef _memory_space_H_
+#define _memory_space_H_
+
+#define MEMORY_SPACE_CODE ('C')
+#define MEMORY_SPACE_XRAM ('X')
+#define XRAM_ADDRESS_MAX (0x7FFF)
+// XRAM from here up holds the monitor's breakpoints, trace, profile and
+// coverage (XRAM_BP_CONDITION in Single_Step_Keil_Compiler/cone.c)
+#define XRAM_MONITOR_BASE (0x5000)
+
+/**
+ * @brief   Checks and normalizes a space selector character.
+ * @param   space - 'C'/'c' for code memory, 'X'/'x' for XRAM.
+ * @return  MEMORY_SPACE_CODE, MEMORY_SPACE_XRAM, or 0 if invalid.
+ */
+unsigned char memory_space_select(unsigned char space);
+
+/**
+ * @brief   Prompts for and reads a space selector from the user.
+ * @param   None
+ * @return  MEMORY_SPACE_CODE, MEMORY_SPACE_XRAM, or 0 if invalid.
+ */
+unsigned char parse_memory_space(void);
+
+/**
+ * @brief   Checks that a range lies inside the selected space.
+ * @param   space - MEMORY_SPACE_CODE or MEMORY_SPACE_XRAM.
+ * @param   start_address - First address of the range.
+ * @param   end_address - Last address of the range.
+ * @return  1 if the range is valid, 0 otherwise.
+ */
+unsigned char memory_range_valid(unsigned char space, unsigned int start_address,
+                                 unsigned int end_address);
+
+/**
+ * @brief   Builds a generic pointer into the selected space.
+ * @param   space - MEMORY_SPACE_CODE or MEMORY_SPACE_XRAM.
+ * @param   address - Address within that space.
+ * @return  Generic pointer usable for reads from either space.
+ */
+unsigned char *memory_pointer(unsigned char space, unsigned int address);
+
+#endif
@@ -0,0 +1,220 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    request.c
+ * @brief   Implements the pipelined request protocol ('Q' command).
+ * @details Each request is read, checked and answered completely before the
+ *          next one is taken from the RX ring. The host hides the link
+ *          latency by sending the following requests while the current one
+ *          is still being answered.
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+#include <at89c51ed2.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "crc.h"
+#include "frame.h"
+#include "memory_space.h"
+#include "request.h"
+#include "xram_memory.h"
+
+#define ESCAPE (27)
+#define RANGE_PAYLOAD_LENGTH (5)
+
+static __xdata unsigned char request_payload[REQUEST_PAYLOAD_MAX];
+static __xdata unsigned char reply_payload[7];
+
+
+static void reply_send(unsigned char seq, unsigned char type, unsigned char *data, unsigned char len);
+static void reply_status(unsigned char seq, unsigned char status);
+static unsigned int payload_word(unsigned char index);
+static unsigned char range_valid(unsigned char len, unsigned char *space);
+static void serve_read(unsigned char seq, unsigned char len);
+static void serve_write(unsigned char seq, unsigned char len);
+static void serve_crc(unsigned char seq, unsigned char len);
+
+
+static void reply_send(unsigned char seq, unsigned char type, unsigned char *data, unsigned char len) {
+    unsigned int crc = CRC16_INIT;
+    unsigned char value;
+
+    putchar(FRAME_SYNC);
+    putchar(seq);
+    crc = crc16_update(crc, seq);
+    putchar(type);
+    crc = crc16_update(crc, type);
+    putchar(len);
+    crc = crc16_update(crc, len);
+
+    while (len--) {
+        value = *data++;
+        putchar(value);
+        crc = crc16_update(crc, value);
+    }
+
+    putchar(crc >> 8);
+    putchar(crc & 0xFF);
+}
+
+static void reply_status(unsigned char seq, unsigned char status) {
+    reply_payload[0] = status;
+    reply_send(seq, REPLY_END, reply_payload, 1);
+}
+
+static unsigned int payload_word(unsigned char index) {
+    return (request_payload[index] << 8) | request_payload[index + 1];
+}
+
+// Checks a space, start, end payload as used by 'R' and 'K'
+static unsigned char range_valid(unsigned char len, unsigned char *space) {
+    if (len != RANGE_PAYLOAD_LENGTH)
+        return 0;
+    *space = memory_space_select(request_payload[0]);
+    return *space && memory_range_valid(*space, payload_word(1), payload_word(3));
+}
+
+static void serve_read(unsigned char seq, unsigned char len) {
+    unsigned char space;
+    unsigned int start_address, end_address;
+    unsigned int remaining;
+    unsigned char count;
+
+    if (!range_valid(len, &space)) {
+        reply_status(seq, REQUEST_BAD_RANGE);
+        return;
+    }
+    start_address = payload_word(1);
+    end_address = payload_word(3);
+
+    while (1) {
+        // remaining is one less than the bytes left, so 0x0000-0xFFFF fits
+        remaining = end_address - start_address;
+        count = (remaining >= FRAME_PAYLOAD_MAX) ? FRAME_PAYLOAD_MAX : remaining + 1;
+        reply_send(seq, REPLY_DATA, memory_pointer(space, start_address), count);
+        if (remaining < FRAME_PAYLOAD_MAX)
+            break;
+        start_address += FRAME_PAYLOAD_MAX;
+    }
+    reply_status(seq, REQUEST_OK);
+}
+
+static void serve_write(unsigned char seq, unsigned char len) {
+    unsigned int start_address;
+    unsigned char i;
+
+    if (len < 3) {
+        reply_status(seq, REQUEST_BAD_FORMAT);
+        return;
+    }
+    start_address = payload_word(0);
+    len -= 2;
+    if (!memory_range_valid(MEMORY_SPACE_XRAM, start_address, start_address + len - 1)) {
+        reply_status(seq, REQUEST_BAD_RANGE);
+        return;
+    }
+    for (i = 0; i < len; i++)
+        xram_write(start_address + i, request_payload[2 + i]);
+    reply_status(seq, REQUEST_OK);
+}
+
+static void serve_crc(unsigned char seq, unsigned char len) {
+    unsigned char space;
+    unsigned int crc16;
+    unsigned long crc32;
+
+    if (!range_valid(len, &space)) {
+        reply_status(seq, REQUEST_BAD_RANGE);
+        return;
+    }
+    memory_checksum(space, payload_word(1), payload_word(3), &crc16, &crc32);
+    reply_payload[0] = REQUEST_OK;
+    reply_payload[1] = crc16 >> 8;
+    reply_payload[2] = crc16 & 0xFF;
+    reply_payload[3] = crc32 >> 24;
+    reply_payload[4] = crc32 >> 16;
+    reply_payload[5] = crc32 >> 8;
+    reply_payload[6] = crc32 & 0xFF;
+    reply_send(seq, REPLY_END, reply_payload, 7);
+}
+
+/*
+ * A request with a bad length or CRC is answered with an error and the
+ * parser hunts for the next sync byte; the host then waits for the line
+ * to go quiet and sends everything from the failed request again. The
+ * rest of the failed request and the ones in flight behind it are binary
+ * and may hold an ESC, so while hunting only a sync byte counts. ESC
+ * leaves only between complete requests: before the first one (a user at
+ * a terminal) or after one that passed its CRC.
+ */
+void request_mode(void) {
+    unsigned char c, seq, op, len, i;
+    unsigned char resync = 0;
+    uint16_t crc, received;
+
+    reply_payload[0] = REQUEST_VERSION;
+    reply_payload[1] = REQUEST_WINDOW;
+    reply_send(0, REPLY_HELLO, reply_payload, 2);
+
+    while (1) {
+        c = getchar();
+        if (c == ESCAPE && !resync)
+            return;
+        if (c != FRAME_SYNC)
+            continue;
+
+        seq = getchar();
+        op = getchar();
+        len = getchar();
+        crc = crc16_update(CRC16_INIT, seq);
+        crc = crc16_update(crc, op);
+        crc = crc16_update(crc, len);
+        if (len > REQUEST_PAYLOAD_MAX) {
+            reply_status(seq, REQUEST_BAD_FORMAT);
+            resync = 1;
+            continue;
+        }
+        for (i = 0; i < len; i++) {
+            c = getchar();
+            request_payload[i] = c;
+            crc = crc16_update(crc, c);
+        }
+        received = (unsigned char)getchar() << 8;
+        received |= (unsigned char)getchar();
+        if (received != crc) {
+            reply_status(seq, REQUEST_BAD_CRC);
+            resync = 1;
+            continue;
+        }
+        resync = 0;
+
+        switch (op) {
+            case REQUEST_READ:
+                serve_read(seq, len);
+                break;
+            case REQUEST_WRITE:
+                serve_write(seq, len);
+                break;
+            case REQUEST_CRC:
+                serve_crc(seq, len);
+                break;
+            case REQUEST_QUIT:
+                reply_status(seq, REQUEST_OK);
+                return;
+            default:
+                reply_status(seq, REQUEST_BAD_FORMAT);
+                break;
+        }
+    }
+}
@@ -0,0 +1,77 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    request.h
+ * @brief   Header file for the pipelined request protocol.
+ * @details After the 'Q' command the editor announces itself with
+ *
+ *              0x7E, 0, 'H', 2, version, window, crc16 (hi, lo)
+ *
+ *          and then serves binary requests until a quit request or ESC:
+ *
+ *              0x7E, seq, op, len, payload[len], crc16 (hi, lo)
+ *
+ *          op 'R' reads a range (payload: space, start hi/lo, end hi/lo),
+ *          'W' writes XRAM (start hi/lo, up to 32 data bytes), 'K' returns
+ *          the range's CRC-16 and CRC-32 (same payload as 'R') and 'Q'
+ *          leaves the mode. Every reply frame has the layout
+ *
+ *              0x7E, seq, type, len, payload[len], crc16 (hi, lo)
+ *
+ *          with the seq of the request it answers. A read sends its data
+ *          as 'D' frames of up to 64 bytes; every request ends with one
+ *          'E' frame whose first payload byte is the status ('K' adds
+ *          CRC-16 hi/lo and CRC-32 MSB first). All CRC-16s cover every
+ *          byte after the sync byte.
+ *
+ *          Requests are answered strictly in order. While one is being
+ *          answered the next ones wait in the UART RX ring, so a host may
+ *          keep up to REQUEST_WINDOW requests outstanding and the link
+ *          never idles between them.
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+
+#ifndef _request_H_
+#define _request_H_
+
+#define REQUEST_VERSION (1)
+#define REQUEST_WINDOW (4)
+#define REQUEST_WRITE_MAX (32)
+#define REQUEST_PAYLOAD_MAX (2 + REQUEST_WRITE_MAX)
+
+#define REQUEST_READ ('R')
+#define REQUEST_WRITE ('W')
+#define REQUEST_CRC ('K')
+#define REQUEST_QUIT ('Q')
+
+#define REPLY_HELLO ('H')
+#define REPLY_DATA ('D')
+#define REPLY_END ('E')
+
+#define REQUEST_OK (0)
+#define REQUEST_BAD_CRC (1)
+#define REQUEST_BAD_FORMAT (2)
+#define REQUEST_BAD_RANGE (3)
+
+/**
+ * @brief   Serves pipelined binary requests until a quit request.
+ * @details ESC received between requests also returns to the prompt,
+ *          but not while hunting for sync after a rejected request.
+ * @param   None
+ * @return  None
+ */
+void request_mode(void);
+
+#endif
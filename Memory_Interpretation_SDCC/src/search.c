@@ -0,0 +1,182 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    search.c
+ * @brief   Implements the on-target pattern search command.
+ * @details Uses Boyer-Moore-Horspool: the byte under the last pattern
+ *          position picks how far the window may jump, so most of a 32 KB
+ *          range is never read. A mask byte of 00 makes that position a
+ *          wildcard; the skip table is built to honour the mask. Only the
+ *          matching addresses go back over the link.
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+#include <at89c51ed2.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "code_memory.h"
+#include "memory_space.h"
+#include "search.h"
+#include "hex_format.h"
+#include "uart.h"
+
+#define NUMBER_BASE (16)
+#define CARRIAGE_RETURN (13)
+#define BACKSPACE (8)
+#define SPACE (32)
+
+static __xdata unsigned char skip_table[256];
+static __xdata unsigned char search_pattern[SEARCH_PATTERN_MAX];
+static __xdata unsigned char search_mask[SEARCH_PATTERN_MAX];
+
+static unsigned char parse_hex_bytes(unsigned char __xdata *buffer, unsigned char max);
+static void build_skip_table(unsigned char *pattern, unsigned char *mask, unsigned char length);
+
+
+static unsigned char parse_hex_bytes(unsigned char __xdata *buffer, unsigned char max) {
+    unsigned char count = 0;
+    unsigned char nibbles = 0;
+    unsigned char current_char = 0;
+
+    while (current_char != CARRIAGE_RETURN) {
+        current_char = getchar();
+        if ((((current_char >= '0') && (current_char <= '9')) ||
+             ((current_char >= 'a') && (current_char <= 'f')) ||
+             ((current_char >= 'A') && (current_char <= 'F'))) && count < max) {
+            putchar(current_char);
+            if (nibbles == 0) {
+                buffer[count] = char_to_int(current_char);
+                nibbles = 1;
+            } else {
+                buffer[count] = (buffer[count] << 4) | char_to_int(current_char);
+                count++;
+                nibbles = 0;
+            }
+        } else if (current_char == SPACE) {
+            putchar(SPACE);
+            if (nibbles) {
+                count++;
+                nibbles = 0;
+            }
+        }
+    }
+    return count + nibbles;
+}
+
+static void build_skip_table(unsigned char *pattern, unsigned char *mask, unsigned char length) {
+    unsigned int c;
+    unsigned char j;
+
+    for (c = 0; c < 256; c++) {
+        skip_table[c] = length;
+        // Later positions give shorter shifts, so the last hit wins
+        for (j = 0; j < length - 1; j++) {
+            if (((unsigned char)c & mask[j]) == pattern[j])
+                skip_table[c] = length - 1 - j;
+        }
+    }
+}
+
+unsigned char memory_search(unsigned char space, unsigned int start_address,
+                            unsigned int end_address, unsigned char *pattern,
+                            unsigned char *mask, unsigned char length) {
+    unsigned char *window;
+    unsigned int last;
+    unsigned char tail, tail_mask, c, j, step;
+    unsigned char hits = 0;
+
+    if (length == 0 || end_address - start_address < length - 1)
+        return 0;
+
+    for (j = 0; j < length; j++)
+        pattern[j] &= mask[j];
+    build_skip_table(pattern, mask, length);
+
+    last = end_address - (length - 1);
+    tail = pattern[length - 1];
+    tail_mask = mask[length - 1];
+    window = memory_pointer(space, start_address);
+
+    while (1) {
+        c = window[length - 1];
+        if ((c & tail_mask) == tail) {
+            for (j = length - 1; j > 0; j--) {
+                if ((window[j - 1] & mask[j - 1]) != pattern[j - 1])
+                    break;
+            }
+            if (j == 0) {
+                uart_puts("\r\n Match at ");
+                putchar(space);
+                putchar(':');
+                print_hex_word(start_address);
+                if (++hits == SEARCH_MAX_HITS)
+                    break;
+            }
+        }
+        step = skip_table[c];
+        if (last - start_address < step)
+            break;
+        start_address += step;
+        window += step;
+    }
+    return hits;
+}
+
+void search_memory(void) {
+    unsigned char space;
+    unsigned int start_address, end_address;
+    unsigned char length, mask_length, j;
+    unsigned char hits;
+
+    space = parse_memory_space();
+    if (!space)
+        return;
+
+    uart_puts("\r\n Enter Start Address (Hex): ");
+    start_address = parse_user_input(NUMBER_BASE);
+    uart_puts("\r\n");
+    uart_puts("\r\n Enter End Address (Hex): ");
+    end_address = parse_user_input(NUMBER_BASE);
+    uart_puts("\r\n");
+    if (!memory_range_valid(space, start_address, end_address)) {
+        uart_puts("\r\n Error: Invalid address range.\r\n");
+        return;
+    }
+
+    uart_puts("\r\n Enter Pattern (up to 16 hex bytes): ");
+    length = parse_hex_bytes(search_pattern, SEARCH_PATTERN_MAX);
+    uart_puts("\r\n");
+    if (length == 0) {
+        uart_puts("\r\n Error: Empty pattern.\r\n");
+        return;
+    }
+
+    uart_puts("\r\n Enter Mask (Enter for none): ");
+    mask_length = parse_hex_bytes(search_mask, SEARCH_PATTERN_MAX);
+    uart_puts("\r\n");
+    for (j = mask_length; j < length; j++)
+        search_mask[j] = 0xFF;
+
+    hits = memory_search(space, start_address, end_address,
+                         search_pattern, search_mask, length);
+    if (hits == SEARCH_MAX_HITS) {
+        uart_puts("\r\n\r\n Stopped after 0x");
+        print_hex_byte(SEARCH_MAX_HITS);
+        uart_puts(" matches.\r\n");
+    } else {
+        uart_puts("\r\n\r\n 0x");
+        print_hex_byte(hits);
+        uart_puts(" match(es) found.\r\n");
+    }
+}
@@ -0,0 +1,49 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    search.h
+ * @brief   Header file for the on-target pattern search command.
+ * @details Declares the byte pattern search over code memory or XRAM.
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+
+#ifndef _search_H_
+#define _search_H_
+
+#define SEARCH_PATTERN_MAX (16)
+#define SEARCH_MAX_HITS (32)
+
+/**
+ * @brief   Scans a range for a byte pattern with an optional bit mask.
+ * @param   space - MEMORY_SPACE_CODE or MEMORY_SPACE_XRAM.
+ * @param   start_address - First address of the range.
+ * @param   end_address - Last address of the range.
+ * @param   pattern - Pattern bytes.
+ * @param   mask - Mask bytes (1 bits must match), one per pattern byte.
+ * @param   length - Pattern length, 1 to SEARCH_PATTERN_MAX.
+ * @return  Number of matches found, at most SEARCH_MAX_HITS.
+ */
+unsigned char memory_search(unsigned char space, unsigned int start_address,
+                            unsigned int end_address, unsigned char *pattern,
+                            unsigned char *mask, unsigned char length);
+
+/**
+ * @brief   Prompts for a range, pattern and mask and prints matching addresses.
+ * @param   None
+ * @return  None
+ */
+void search_memory(void);
+
+#endif
@@ -0,0 +1,287 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    uart.c
+ * @brief   Implements the interrupt-driven, ring-buffered UART driver.
+ * @details putchar() only queues a byte in an XRAM ring and returns, so the
+ *          dump routines can format the next row while the serial ISR is
+ *          still shifting out the previous one. Received bytes are buffered
+ *          the same way and handed out by getchar().
+ *
+ *          The baud clock comes from the AT89C51ED2 internal baud rate
+ *          generator with SMOD1 = 1 and SPD = 1, which reaches 115200 baud
+ *          from 11.0592 MHz (Timer 1 tops out at 9600 with TH1 = 0xFD here).
+ *          Rates are changed at run time by the 'U' handshake.
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+#include <at89c51ed2.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "uart.h"
+
+// 256 entries so the TX indices wrap for free as unsigned char
+#define UART_TX_BUFFER_SIZE (256)
+// Holds REQUEST_WINDOW pipelined requests of the largest size (request.h)
+#define UART_RX_BUFFER_SIZE (256)
+#define UART_RX_MASK (UART_RX_BUFFER_SIZE - 1)
+
+// Timer 0 mode 1 reload for 5 ms at 11.0592 MHz (4608 machine cycles)
+#define TIMER0_5MS_HIGH (0xEE)
+#define TIMER0_5MS_LOW (0x00)
+#define BAUD_CONFIRM_TICKS (400)
+#define BAUD_CONFIRM_CHAR ('Y')
+
+// BRL = 256 - 345600 / baud, from baud = 2^SMOD1 * (Fosc / 2) / (32 * (256 - BRL))
+static __code const unsigned char baud_reload[UART_BAUD_COUNT] = {
+    0xDC, 0xEE, 0xF7, 0xFA, 0xFD
+};
+static __code const char * __code const baud_names[UART_BAUD_COUNT] = {
+    "9600", "19200", "38400", "57600", "115200"
+};
+
+static __xdata unsigned char tx_buffer[UART_TX_BUFFER_SIZE];
+static __xdata unsigned char rx_buffer[UART_RX_BUFFER_SIZE];
+
+// Indices live in IRAM so the ISR touches DPTR only for the data itself
+static volatile __data unsigned char tx_head;
+static volatile __data unsigned char tx_tail;
+static volatile __data unsigned char rx_head;
+static volatile __data unsigned char rx_tail;
+static volatile __bit tx_busy;
+
+static volatile __xdata unsigned int tx_overrun_count;
+static volatile __xdata unsigned int rx_overrun_count;
+
+static void uart_enqueue(unsigned char c);
+
+
+void uart_isr(void) __interrupt(4) {
+    unsigned char next;
+
+    if (RI) {
+        RI = 0;
+        next = (rx_head + 1) & UART_RX_MASK;
+        if (next != rx_tail) {
+            rx_buffer[rx_head] = SBUF;
+            rx_head = next;
+        } else {
+            rx_overrun_count++;
+        }
+    }
+
+    if (TI) {
+        TI = 0;
+        if (tx_tail != tx_head) {
+            SBUF = tx_buffer[tx_tail];
+            tx_tail++;
+        } else {
+            tx_busy = 0;
+        }
+    }
+}
+
+void uart_initialization(void) {
+    ES = 0;
+    tx_head = 0;
+    tx_tail = 0;
+    rx_head = 0;
+    rx_tail = 0;
+    tx_busy = 0;
+    tx_overrun_count = 0;
+    rx_overrun_count = 0;
+
+    // Keep the rate if the monitor already negotiated one
+    if (!(BDRCON & BRR)) {
+        BRL = baud_reload[UART_BAUD_9600];
+    }
+    SCON = 0x50;
+    PCON |= SMOD;
+    BDRCON = BRR | TBCK | RBCK | SPD;
+    TI = 0;
+    RI = 0;
+    ES = 1;
+    EA = 1;
+}
+
+void uart_release(void) {
+    uart_flush();
+    ES = 0;
+    TI = 1;
+}
+
+static void uart_enqueue(unsigned char c) {
+    ES = 0;
+    if (tx_busy) {
+        tx_buffer[tx_head] = c;
+        tx_head++;
+    } else {
+        // Transmitter idle: start it directly, the ISR takes over from here
+        tx_busy = 1;
+        SBUF = c;
+    }
+    ES = 1;
+}
+
+void uart_write(const char *buffer, unsigned char length) {
+    unsigned char head;
+
+    if (length == 0)
+        return;
+    while ((unsigned char)(tx_tail - tx_head - 1) < length);
+
+    // Copy with the interrupt enabled; the ISR never reads past tx_head
+    head = tx_head;
+    while (length--) {
+        tx_buffer[head] = *buffer++;
+        head++;
+    }
+
+    ES = 0;
+    tx_head = head;
+    if (!tx_busy) {
+        tx_busy = 1;
+        SBUF = tx_buffer[tx_tail];
+        tx_tail++;
+    }
+    ES = 1;
+}
+
+void uart_puts(const char *str) {
+    while (*str) {
+        putchar(*str++);
+    }
+}
+
+unsigned char uart_try_putchar(unsigned char c) {
+    if ((unsigned char)(tx_head + 1) == tx_tail) {
+        ES = 0;
+        tx_overrun_count++;
+        ES = 1;
+        return 0;
+    }
+    uart_enqueue(c);
+    return 1;
+}
+
+int putchar(int c) {
+    while ((unsigned char)(tx_head + 1) == tx_tail);
+    uart_enqueue(c);
+    return c;
+}
+
+int getchar(void) {
+    unsigned char c;
+
+    while (rx_head == rx_tail);
+    c = rx_buffer[rx_tail];
+    rx_tail = (rx_tail + 1) & UART_RX_MASK;
+    return c;
+}
+
+void uart_flush(void) {
+    while (tx_busy);
+}
+
+void uart_set_baud(unsigned char index) {
+    uart_flush();
+    BDRCON &= ~BRR;
+    BRL = baud_reload[index];
+    BDRCON |= BRR;
+}
+
+unsigned char uart_wait_rx(unsigned int ticks) {
+    TMOD = (TMOD & 0xF0) | 0x01;
+    while (ticks--) {
+        TR0 = 0;
+        TH0 = TIMER0_5MS_HIGH;
+        TL0 = TIMER0_5MS_LOW;
+        TF0 = 0;
+        TR0 = 1;
+        while (!TF0) {
+            if (uart_rx_available()) {
+                TR0 = 0;
+                return 1;
+            }
+        }
+    }
+    TR0 = 0;
+    return 0;
+}
+
+void change_baud_rate(void) {
+    unsigned char choice;
+    unsigned char old_reload;
+    unsigned char index;
+
+    uart_puts("\r\n Baud Rate (1 = 9600, 2 = 19200, 3 = 38400, 4 = 57600, 5 = 115200): ");
+    choice = getchar();
+    putchar(choice);
+    uart_puts("\r\n");
+    if (choice < '1' || choice >= '1' + UART_BAUD_COUNT) {
+        uart_puts("\r\n Invalid Baud Rate.\r\n");
+        return;
+    }
+    index = choice - '1';
+
+    // Acknowledge at the old rate, then both sides switch and the host
+    // proves the new rate by sending BAUD_CONFIRM_CHAR within 2 seconds
+    uart_puts("\r\n ACK ");
+    uart_puts(baud_names[index]);
+    uart_puts("\r\n");
+    old_reload = BRL;
+    uart_set_baud(index);
+
+    while (uart_rx_available())
+        getchar();
+    if (uart_wait_rx(BAUD_CONFIRM_TICKS) && getchar() == BAUD_CONFIRM_CHAR) {
+        uart_puts("\r\n OK ");
+        uart_puts(baud_names[index]);
+        uart_puts("\r\n");
+        return;
+    }
+
+    uart_flush();
+    BDRCON &= ~BRR;
+    BRL = old_reload;
+    BDRCON |= BRR;
+    uart_puts("\r\n Baud change failed, rate unchanged.\r\n");
+}
+
+unsigned char uart_rx_available(void) {
+    return (rx_head - rx_tail) & UART_RX_MASK;
+}
+
+unsigned char uart_peek(void) {
+    while (rx_head == rx_tail);
+    return rx_buffer[rx_tail];
+}
+
+unsigned int uart_tx_overruns(void) {
+    unsigned int count;
+
+    ES = 0;
+    count = tx_overrun_count;
+    ES = 1;
+    return count;
+}
+
+unsigned int uart_rx_overruns(void) {
+    unsigned int count;
+
+    ES = 0;
+    count = rx_overrun_count;
+    ES = 1;
+    return count;
+}
@@ -0,0 +1,143 @@
+/*****************************************************************************
+ * Copyright (C) 2024 by Bhavya Saravanan
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users
+ * are permitted to modify this and use it to learn about the field of
+ * embedded software. Bhavya Saravanan and the University of Colorado are not
+ * liable for any misuse of this material.
+ *****************************************************************************/
+
+/**
+ * @file    uart.h
+ * @brief   Header file for the interrupt-driven UART driver.
+ * @details Declares the serial ISR and the ring-buffered transmit/receive
+ *          functions used by every output path of the memory editor.
+ * @author  Bhavya Saravanan
+ * @date    December 14, 2024
+ * @version 1.0
+ */
+
+
+
+#ifndef _uart_H_
+#define _uart_H_
+
+#define UART_BAUD_9600 (0)
+#define UART_BAUD_19200 (1)
+#define UART_BAUD_38400 (2)
+#define UART_BAUD_57600 (3)
+#define UART_BAUD_115200 (4)
+#define UART_BAUD_COUNT (5)
+
+/**
+ * @brief   Serial port interrupt service routine.
+ * @details Moves received bytes into the RX ring and feeds SBUF from the
+ *          TX ring. The prototype must be visible in main.c for SDCC to
+ *          place the vector.
+ * @param   None
+ * @return  None
+ */
+void uart_isr(void) __interrupt(4);
+
+/**
+ * @brief   Initializes the UART on the internal baud rate generator and
+ *          enables its interrupt.
+ * @details Starts at 9600 baud unless the generator is already running,
+ *          in which case the rate negotiated by the monitor is kept.
+ * @param   None
+ * @return  None
+ */
+void uart_initialization(void);
+
+/**
+ * @brief   Waits until every queued byte has left the shift register and
+ *          hands the port back to polled operation for the monitor.
+ * @param   None
+ * @return  None
+ */
+void uart_release(void);
+
+/**
+ * @brief   Queues a byte for transmission without waiting.
+ * @param   c - The byte to transmit.
+ * @return  1 if the byte was queued, 0 if the TX ring was full.
+ */
+unsigned char uart_try_putchar(unsigned char c);
+
+/**
+ * @brief   Queues a whole buffer with one call, waiting for ring space once.
+ * @param   buffer - Characters to send.
+ * @param   length - Number of characters, at most 255.
+ * @return  None
+ */
+void uart_write(const char *buffer, unsigned char length);
+
+/**
+ * @brief   Sends a null-terminated string (no newline is appended).
+ * @param   str - The string to send.
+ * @return  None
+ */
+void uart_puts(const char *str);
+
+/**
+ * @brief   Blocks until the TX ring is empty and the last byte is sent.
+ * @param   None
+ * @return  None
+ */
+void uart_flush(void);
+
+/**
+ * @brief   Switches the UART to another rate after draining the TX ring.
+ * @param   index - One of the UART_BAUD_ constants.
+ * @return  None
+ */
+void uart_set_baud(unsigned char index);
+
+/**
+ * @brief   Renegotiates the baud rate with the host ('U' command).
+ * @details Sends "ACK <rate>" at the old rate, switches, and keeps the new
+ *          rate only if the host sends 'Y' at that rate within 2 seconds.
+ * @param   None
+ * @return  None
+ */
+void change_baud_rate(void);
+
+/**
+ * @brief   Returns the number of received bytes waiting in the RX ring.
+ * @param   None
+ * @return  Number of bytes available to getchar().
+ */
+unsigned char uart_rx_available(void);
+
+/**
+ * @brief   Waits for a received byte without taking it from the RX ring.
+ * @details Uses Timer 0 in mode 1 while it waits.
+ * @param   ticks - Time limit in units of 5 ms.
+ * @return  1 if a byte is available, 0 on timeout.
+ */
+unsigned char uart_wait_rx(unsigned int ticks);
+
+/**
+ * @brief   Returns the next received byte without removing it.
+ * @details Blocks like getchar() while the RX ring is empty.
+ * @param   None
+ * @return  The byte getchar() will return next.
+ */
+unsigned char uart_peek(void);
+
+/**
+ * @brief   Returns the number of bytes dropped because the TX ring was full.
+ * @param   None
+ * @return  TX overrun count.
+ */
+unsigned int uart_tx_overruns(void);
+
+/**
+ * @brief   Returns the number of bytes dropped because the RX ring was full.
+ * @param   None
+ * @return  RX overrun count.
+ */
+unsigned int uart_rx_overruns(void);
+
+#endif
@@ -25,9 +25,11 @@
 #include <stdint.h>
 #include "code_memory.h"
 #include "xram_memory.h"
+#include "memory_space.h"
+#include "hex_format.h"
+#include "uart.h"
 
 
-#define DIVIDE_BY_16 (16)
 #define NUMBER_BASE (16)
 #define DATA_MAX (255)
 #define ADDRESS_MAX (0x7FFF)
@@ -38,12 +40,155 @@ unsigned char xram_read(unsigned int address);
 void read_memory(void);
 void memory_read(unsigned int start_address, unsigned int end_address);
 
+static unsigned char write_range_valid(unsigned int start_address, unsigned int end_address);
+
+// Operands for the fill loop, kept in IRAM so the inline assembly can load
+// them directly
+static __data unsigned int fill_address;
+static __data unsigned int fill_count;
+static __data unsigned char fill_value;
+
+// Operands for the copy loops; the count is pre-split for two DJNZ counters
+static __data unsigned int copy_source;
+static __data unsigned int copy_destination;
+static __data unsigned char copy_loops_low;
+static __data unsigned char copy_loops_high;
+
 void initialize_xram(void) {
-    unsigned int address;
-    for (address = 0x0000; address <= ADDRESS_MAX; address++) {
-        xram_write(address, 0xFF);
+    xram_fill(0x0000, XRAM_MONITOR_BASE - 1, 0xFF);
+}
+
+/*
+ * The inner loop is MOVX @DPTR,A / INC DPTR / DJNZ = 6 machine cycles per
+ * byte, so clearing the 20 KB below the monitor's block takes about 0.13 s
+ * at 11.0592 MHz. The old per-byte xram_write() call cost well over 50
+ * cycles per byte.
+ */
+void xram_fill(unsigned int start_address, unsigned int end_address, unsigned char data) {
+    if (end_address < start_address)
+        return;
+
+    fill_address = start_address;
+    fill_count = end_address - start_address + 1;
+    fill_value = data;
+
+    __asm
+        mov     dpl, _fill_address
+        mov     dph, (_fill_address + 1)
+        mov     r6, _fill_count
+        mov     r7, (_fill_count + 1)
+        ; Two nested DJNZ counters: bump the high byte when the low byte
+        ; is not zero so the outer loop runs the right number of times
+        mov     a, r6
+        jz      00001$
+        inc     r7
+00001$:
+        mov     a, _fill_value
+00002$:
+        movx    @dptr, a
+        inc     dptr
+        djnz    r6, 00002$
+        djnz    r7, 00002$
+    __endasm;
+}
+
+/*
+ * DPTR0 holds the source and DPTR1 the destination; INC AUXR1 toggles DPS
+ * (bit 2 of AUXR1 always reads 0), so neither pointer is reloaded per byte.
+ * Machine cycles per byte:
+ *   XRAM -> XRAM forward : 12  (1/12 byte per cycle, ~77 KB/s)
+ *   code -> XRAM         : 13  (1/13 byte per cycle, ~71 KB/s)
+ *   XRAM -> XRAM backward: 19  (1/19 byte per cycle, ~48 KB/s)
+ * The backward loop is only used when the destination overlaps the tail
+ * of the source, because the 8051 has no DEC DPTR.
+ */
+void xram_copy(unsigned char space, unsigned int source, unsigned int destination,
+               unsigned int length) {
+    if (length == 0)
+        return;
+
+    copy_loops_low = length & 0xFF;
+    copy_loops_high = (length >> 8) + (copy_loops_low != 0);
+
+    if (space == MEMORY_SPACE_CODE) {
+        copy_source = source;
+        copy_destination = destination;
+        __asm
+            mov     dpl, _copy_source
+            mov     dph, (_copy_source + 1)
+            inc     _AUXR1
+            mov     dpl, _copy_destination
+            mov     dph, (_copy_destination + 1)
+            inc     _AUXR1
+            mov     r6, _copy_loops_low
+            mov     r7, _copy_loops_high
+00001$:
+            clr     a
+            movc    a, @a+dptr
+            inc     dptr
+            inc     _AUXR1
+            movx    @dptr, a
+            inc     dptr
+            inc     _AUXR1
+            djnz    r6, 00001$
+            djnz    r7, 00001$
+        __endasm;
+    } else if (destination <= source || destination - source >= length) {
+        copy_source = source;
+        copy_destination = destination;
+        __asm
+            mov     dpl, _copy_source
+            mov     dph, (_copy_source + 1)
+            inc     _AUXR1
+            mov     dpl, _copy_destination
+            mov     dph, (_copy_destination + 1)
+            inc     _AUXR1
+            mov     r6, _copy_loops_low
+            mov     r7, _copy_loops_high
+00002$:
+            movx    a, @dptr
+            inc     dptr
+            inc     _AUXR1
+            movx    @dptr, a
+            inc     dptr
+            inc     _AUXR1
+            djnz    r6, 00002$
+            djnz    r7, 00002$
+        __endasm;
+    } else {
+        // Overlapping with destination above source: copy from the top down
+        copy_source = source + length - 1;
+        copy_destination = destination + length - 1;
+        __asm
+            mov     dpl, _copy_source
+            mov     dph, (_copy_source + 1)
+            inc     _AUXR1
+            mov     dpl, _copy_destination
+            mov     dph, (_copy_destination + 1)
+            inc     _AUXR1
+            mov     r6, _copy_loops_low
+            mov     r7, _copy_loops_high
+00003$:
+            movx    a, @dptr
+            mov     r5, a
+            mov     a, dpl
+            jnz     00004$
+            dec     dph
+00004$:
+            dec     dpl
+            inc     _AUXR1
+            mov     a, r5
+            movx    @dptr, a
+            mov     a, dpl
+            jnz     00005$
+            dec     dph
+00005$:
+            dec     dpl
+            inc     _AUXR1
+            djnz    r6, 00003$
+            djnz    r7, 00003$
+        __endasm;
     }
-   
 }
 
 void xram_write(unsigned int address, unsigned char data) {
@@ -59,74 +204,134 @@ unsigned char xram_read(unsigned int address) {
 void write_memory(void) {
     unsigned int start_address, end_address;
     unsigned char data;
+    unsigned char echo;
 
-    printf("\r\n Enter Start Address to Write (Hex): ");
+    uart_puts("\r\n Enter Start Address to Write (Hex): ");
     //printf("\r\n ");
     start_address = parse_user_input(NUMBER_BASE);
-     printf("\r\n");
-    printf("\r\n Enter End Address to Write (Hex): ");
+     uart_puts("\r\n");
+    uart_puts("\r\n Enter End Address to Write (Hex): ");
     //printf("\r\n");
     end_address = parse_user_input(NUMBER_BASE);
 
-    if (end_address < start_address) {
-        printf("\r\n Error: End Address must be greater than or equal to Start Address.\r\n");
+    if (!write_range_valid(start_address, end_address))
         return;
-    }
-    printf("\r\n");
-    printf("\r\n Enter Data to Write (Hex): ");
+    uart_puts("\r\n");
+    uart_puts("\r\n Enter Data to Write (Hex): ");
      // printf("\r\n");
     data = parse_user_input(NUMBER_BASE);
-    printf("\r\n");
-    printf("\r\n---------------------------XRAM WRITE----------------------------\r\n");
-    printf("\r\n");
-    printf("Addr: +0  +1  +2  +3  +4  +5  +6  +7  +8  +9  +A  +B  +C  +D  +E  +F\r\n");
-
-    for (unsigned int addr = start_address; addr <= end_address; addr++) {
-        if ((addr - start_address) % DIVIDE_BY_16 == 0) {
-            printf("\r\n%04X: ", addr);
-        }
-        printf("%02X  ", data);
-        xram_write(addr, data);
+    uart_puts("\r\n");
+    uart_puts("\r\n Echo Written Data (Y/N): ");
+    echo = getchar();
+    putchar(echo);
+    uart_puts("\r\n");
+
+    write_memory_range(start_address, end_address, data, echo == 'Y' || echo == 'y');
+}
+
+static unsigned char write_range_valid(unsigned int start_address, unsigned int end_address) {
+    if (end_address < start_address) {
+        uart_puts("\r\n Error: End Address must be greater than or equal to Start Address.\r\n");
+        return 0;
     }
-      printf("\r\n");
+    if (end_address > ADDRESS_MAX) {
+        uart_puts("\r\n Error: End Address must not exceed 0x7FFF.\r\n");
+        return 0;
+    }
+    return 1;
+}
+
+void write_memory_range(unsigned int start_address, unsigned int end_address,
+                        unsigned char data, unsigned char echo) {
+    if (!write_range_valid(start_address, end_address))
+        return;
+
+    xram_fill(start_address, end_address, data);
 
-    printf("\r\n---------------------------------------------------------------------\r\n");
-    printf("\r\n Data 0x%02X written to addresses 0x%04X to 0x%04X.\r\n", data, start_address, end_address);
+    if (echo) {
+        // Read the range back so the echo also verifies the write
+        uart_puts("\r\n---------------------------XRAM WRITE----------------------------\r\n");
+        uart_puts("\r\n");
+        uart_puts("Addr: +0  +1  +2  +3  +4  +5  +6  +7  +8  +9  +A  +B  +C  +D  +E  +F\r\n");
+        memory_read(start_address, end_address);
+        uart_puts("\r\n---------------------------------------------------------------------\r\n");
+    }
+    uart_puts("\r\n Data 0x");
+    print_hex_byte(data);
+    uart_puts(" written to addresses 0x");
+    print_hex_word(start_address);
+    uart_puts(" to 0x");
+    print_hex_word(end_address);
+    uart_puts(".\r\n");
 }
 
 void read_memory(void) {
     unsigned int start_address, end_address;
 
-    printf("\r\n Enter Start Address to Read (Hex): ");
+    uart_puts("\r\n Enter Start Address to Read (Hex): ");
     //printf("\r\n");
     start_address = parse_user_input(NUMBER_BASE);
-     printf("\r\n");
-    printf("\r\n Enter End Address to Read (Hex): ");
+     uart_puts("\r\n");
+    uart_puts("\r\n Enter End Address to Read (Hex): ");
     //printf("\r\n");
     end_address = parse_user_input(NUMBER_BASE);
+    read_memory_range(start_address, end_address);
+}
 
+void read_memory_range(unsigned int start_address, unsigned int end_address) {
     if (end_address < start_address) {
-        printf("\r\n Error: End Address must be greater than or equal to Start Address.\r\n");
+        uart_puts("\r\n Error: End Address must be greater than or equal to Start Address.\r\n");
         return;
     }
 
-    printf("\r\n--------------------------XRAM CONTENTS--------------------------\r\n");
-    printf("\r\n");
-    printf("Addr: +0  +1  +2  +3  +4  +5  +6  +7  +8  +9  +A  +B  +C  +D  +E  +F\r\n");
+    uart_puts("\r\n--------------------------XRAM CONTENTS--------------------------\r\n");
+    uart_puts("\r\n");
+    uart_puts("Addr: +0  +1  +2  +3  +4  +5  +6  +7  +8  +9  +A  +B  +C  +D  +E  +F\r\n");
     memory_read(start_address, end_address);
-    printf("\r\n------------------------------------------------------------------\r\n");
+    uart_puts("\r\n------------------------------------------------------------------\r\n");
 }
 
 void memory_read(unsigned int start_address, unsigned int end_address) {
-    unsigned char count = 0;
-
-    while (start_address <= end_address) {
-        if (count % DIVIDE_BY_16 == 0) {
-            printf("\r\n%04X: ", start_address);
-        }
-        printf("%02X  ", xram_read(start_address));
-        start_address++;
-        count++;
+    hex_dump(MEMORY_SPACE_XRAM, start_address, end_address);
+}
+
+void move_memory(void) {
+    unsigned char space;
+    unsigned int start_address, end_address, destination;
+    unsigned int length;
+
+    space = parse_memory_space();
+    if (!space)
+        return;
+
+    uart_puts("\r\n Enter Source Start Address (Hex): ");
+    start_address = parse_user_input(NUMBER_BASE);
+    uart_puts("\r\n");
+    uart_puts("\r\n Enter Source End Address (Hex): ");
+    end_address = parse_user_input(NUMBER_BASE);
+    uart_puts("\r\n");
+    if (!memory_range_valid(space, start_address, end_address)) {
+        uart_puts("\r\n Error: Invalid source range.\r\n");
+        return;
     }
-    printf("\r\n");
-}
\ No newline at end of file
+
+    uart_puts("\r\n Enter XRAM Destination Address (Hex): ");
+    destination = parse_user_input(NUMBER_BASE);
+    uart_puts("\r\n");
+    length = end_address - start_address + 1;
+    if (length == 0 || destination > ADDRESS_MAX || ADDRESS_MAX - destination < length - 1) {
+        uart_puts("\r\n Error: Destination range exceeds XRAM.\r\n");
+        return;
+    }
+
+    xram_copy(space, start_address, destination, length);
+    uart_puts("\r\n Copied 0x");
+    print_hex_word(length);
+    uart_puts(" bytes from ");
+    putchar(space);
+    putchar(':');
+    print_hex_word(start_address);
+    uart_puts(" to X:");
+    print_hex_word(destination);
+    uart_puts(".\r\n");
+}
@@ -23,11 +23,34 @@
 #define _xram_memorT_H_
 /**
  * @brief   Initializes the XRAM memory space with default values.
+ * @details Stops below XRAM_MONITOR_BASE, so the monitor's breakpoints,
+ *          trace, profile and coverage survive a visit to the editor.
  * @param   None
  * @return  None
  */
 void initialize_xram(void);
 
+/**
+ * @brief   Fills an XRAM range with one value using a tight MOVX loop.
+ * @param   start_address - The first XRAM address to write.
+ * @param   end_address - The last XRAM address to write (inclusive).
+ * @param   data - The value to store.
+ * @return  None
+ */
+void xram_fill(unsigned int start_address, unsigned int end_address, unsigned char data);
+
+/**
+ * @brief   Copies a block into XRAM using both data pointers.
+ * @details Overlapping XRAM ranges are handled like memmove().
+ * @param   space - Source space, MEMORY_SPACE_CODE or MEMORY_SPACE_XRAM.
+ * @param   source - First source address.
+ * @param   destination - First XRAM destination address.
+ * @param   length - Number of bytes to copy.
+ * @return  None
+ */
+void xram_copy(unsigned char space, unsigned int source, unsigned int destination,
+               unsigned int length);
+
 /**
  * @brief   Writes data to a specified XRAM memory address.
  * @param   address - The XRAM memory address to write to.
@@ -50,6 +73,14 @@ unsigned char xram_read(unsigned int address);
  */
 void read_memory(void);
 
+/**
+ * @brief   Displays an XRAM range with the table header, after checking it.
+ * @param   start_address - The starting address in XRAM memory.
+ * @param   end_address - The ending address in XRAM memory.
+ * @return  None
+ */
+void read_memory_range(unsigned int start_address, unsigned int end_address);
+
 /**
  * @brief   Reads and displays XRAM memory data within a specified range.
  * @param   start_address - The starting address in XRAM memory.
@@ -60,9 +91,28 @@ void memory_read(unsigned int start_address, unsigned int end_address);
 
 /**
  * @brief   Writes a user-defined value to a specified range in XRAM memory.
+ * @details The range is filled first; echoing it back is optional.
  * @param   None
  * @return  None
  */
 void write_memory(void);
 
+/**
+ * @brief   Fills an XRAM range with a value after checking the range.
+ * @param   start_address - First address to write.
+ * @param   end_address - Last address to write, at most 0x7FFF.
+ * @param   data - The value to write.
+ * @param   echo - Non-zero to read the range back after the fill.
+ * @return  None
+ */
+void write_memory_range(unsigned int start_address, unsigned int end_address,
+                        unsigned char data, unsigned char echo);
+
+/**
+ * @brief   Copies a code or XRAM block to an XRAM destination.
+ * @param   None
+ * @return  None
+ */
+void move_memory(void);
+
 #endif 
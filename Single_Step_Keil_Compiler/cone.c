@@ -14,64 +14,411 @@
  * @details This program implements single-step execution for user code in 
  *          the AT89C51RC2 microcontroller. Using INT1 (configured as level-triggered),
  *          the debugger monitors and prints the updated register values 
- *          (ACC, B, PSW, SP, DPTR, R0-R7, PC) after each instruction execution.
+ *          (ACC, B, PSW, SP, DPTR, R0-R7, PC) after each instruction execution,
+ *          either as an ASCII table or as compact binary snapshot frames for
+ *          the host-side step_view renderer.
  *          It also provides UART-based interaction for user commands and address entry.
  * @date    December 14, 2024
  * @version 1.0
  */
 
+// Interrupt vectors are in vectors.a51: the serial vector is shared with
+// the memory editor and chooses between it and break_handler()
+#pragma NOIV
+
 #include <REG51.H>
-#include <stdio.h>
+#include <intrins.h>
+
+// AT89C51ED2 internal baud rate generator (not declared in REG51.H)
+sfr BDRCON = 0x9B;
+sfr BRL    = 0x9A;
+#define BDRCON_BRR  0x10        // Baud rate generator run
+#define BDRCON_TBCK 0x08        // UART transmit clocked by the generator
+#define BDRCON_RBCK 0x04        // UART receive clocked by the generator
+#define BDRCON_SPD  0x02        // Fast generator (no /6 prescaler)
+#define PCON_SMOD1  0x80        // Double the UART rate
+
+// Programmable counter array, counting machine cycles (CMOD = 0: Fosc/12)
+sfr CCON = 0xD8;
+sfr CMOD = 0xD9;
+sfr CL   = 0xE9;
+sfr CH   = 0xF9;
+sbit CR  = CCON^6;              // PCA counter run
+
+#define BAUD_COUNT          5
+#define BAUD_CONFIRM_TICKS  40  // 40 x 50 ms for the host to confirm a new rate
+#define BAUD_CONFIRM_CHAR   'Y'
+
+// BRL = 256 - 345600 / baud at 11.0592 MHz with SMOD1 = 1 and SPD = 1
+unsigned char code baud_reload[BAUD_COUNT] = { 0xDC, 0xEE, 0xF7, 0xFA, 0xFD };
+char code * code baud_names[BAUD_COUNT] = { "9600", "19200", "38400", "57600", "115200" };
+
+#define STEP_FRAME_SYNC     0xA5    // First byte of a binary register snapshot
+#define STEP_FRAME_LENGTH   22      // ACC B PSW DPH DPL R0-R7 SP PCH PCL,
+                                    // step cycles (2), total cycles (4)
+#define DELTA_FRAME_SYNC    0xA6    // Changed registers only, see send_delta()
+#define DELTA_REGS          14      // ACC B PSW DPH DPL R0-R7 SP
+#define DELTA_TOTAL_RESTART 0x4000  // Mask bit: total restarts from this step
+#define PSW_PARITY          0x01
+#define BREAK_CHAR          0x03    // Ctrl-C stops a program started with 'J'
+#define BREAK_DUMP_LENGTH   16
+#define BP_MAX              8       // Breakpoint table entries
+#define STEP_GOAL_NONE      0
+#define STEP_GOAL_OVER      1       // Run until the call at the PC returns
+#define STEP_GOAL_OUT       2       // Run until the current function returns
+#define OP_LCALL            0x12
+#define OP_ACALL_MASK       0x1F    // ACALL is aaa10001
+#define OP_ACALL            0x11
+#define OP_RET              0x22
+#define WATCH_MAX           4       // Watched data ranges
+#define WATCH_LENGTH_MAX    64
+#define WATCH_XRAM          'X'
+#define WATCH_IRAM          'I'
+#define WATCH_IRAM_FIRST    0x08    // R0-R7 hold monitor values in the handler
+
+// Monitor variables in XRAM, above the area user programs normally use.
+// The memory editor's start-up fill stops below XRAM_MONITOR_BASE
+// (Memory_Interpretation_SDCC/src/memory_space.h), which must stay equal
+// to XRAM_BP_CONDITION.
+#define XRAM_BP_CONDITION   0x5000  // BP_MAX x COND_MAX bytecode programs
+#define XRAM_BP_HITS        0x5100  // BP_MAX hit counters
+#define XRAM_COND_STACK     0x5110  // COND_STACK_DEPTH evaluation stack
+#define XRAM_TRACE_STATE    0x5120  // Trace write position and last registers
+#define XRAM_PROFILE_STATE  0x5140  // Profiler settings and sample counts
+#define XRAM_COVERAGE_STATE 0x5150  // Coverage bitmap marker
+#define XRAM_WATCH          0x5160  // Watchpoint ranges
+#define XRAM_DELTA          0x5170  // Registers as last reported
+#define XRAM_RUN_STATE      0x5180  // Step and run state, see run_state_init()
+#define RUN_STATE_SIZE      0x40
+#define XRAM_WATCH_SHADOW   0x5200  // WATCH_MAX x WATCH_LENGTH_MAX copies
+#define XRAM_COND_UPLOAD    0x5300  // Condition received before its checksum
+#define XRAM_PROFILE        0x5800  // PROFILE_BUCKETS 16-bit counters
+#define XRAM_TRACE          0x6000  // TRACE_BLOCKS x TRACE_BLOCK_SIZE ring
+#define XRAM_COVERAGE       0x7000  // COVERAGE_SIZE bytes, one bit per address
+
+// Trace ring: every block starts with a keyframe, so the blocks that
+// survive a wrap decode on their own. A record is a control byte
+// (TRACE_PC_* | TRACE_ACC | number of index/value pairs), an absolute PC
+// if TRACE_PC_ABS, ACC if TRACE_ACC, then the pairs for the other
+// registers that changed (snapshot frame order). PSW.P is not compared:
+// it always follows ACC. Records never straddle a block; TRACE_END marks
+// the unused tail.
+#define TRACE_BLOCKS        16
+#define TRACE_BLOCK_SIZE    256
+#define TRACE_SIZE          (TRACE_BLOCKS * TRACE_BLOCK_SIZE)
+#define TRACE_RECORD_MAX    30      // Control, PC, ACC and 13 pairs
+#define TRACE_REGS          14      // ACC B PSW DPH DPL R0-R7 SP
+#define TRACE_KEYFRAME      0x80    // Followed by a full 16-byte snapshot
+#define TRACE_END           0xFF
+#define TRACE_PC_ABS        0x00    // Bits 5-6: PC advanced by 1-3, or 0
+#define TRACE_ACC           0x10    //   for an absolute PC after the control
+#define TRACE_DUMP_SYNC     0x5A
+#define TRACE_MAGIC         0x7EAC  // Marks the trace state as valid after reset
+
+// PC-sampling profiler: Timer 0 interrupts the user program every
+// PROFILE_PERIOD cycles (prime, so it does not lock onto loop lengths)
+// and counts the interrupted PC in bucket (PC - base) >> shift
+#define PROFILE_BUCKETS     1024
+#define PROFILE_SHIFT_MAX   7       // Buckets of 1 to 128 bytes
+#define PROFILE_PERIOD      997
+#define PROFILE_RELOAD      (65536 - PROFILE_PERIOD)
+#define PROFILE_STOP_CHAR   0x1B    // ESC from the host ends profiling
+#define PROFILE_DUMP_SYNC   0x5B
+#define PROFILE_MAGIC       0x7EAD
+
+// Coverage: bit (PC & 7) of byte (PC - COVERAGE_BASE) >> 3 is set when
+// the instruction at PC is reached in a coverage run. 32 KB of code from
+// the user program area up.
+#define COVERAGE_BASE       0x4000
+#define COVERAGE_SPAN       0x8000
+#define COVERAGE_SIZE       (COVERAGE_SPAN / 8)
+#define COVERAGE_DUMP_SYNC  0x5C
+#define COVERAGE_MAGIC      0x7EAE
+
+// Breakpoint condition bytecode, produced by Host_Tools/bp_cond. A program
+// is a postfix expression over 16-bit values ending in COND_END; the
+// breakpoint stops when the value left on top is non-zero.
+#define COND_MAX            32      // Bytes per program including COND_END
+#define COND_STACK_DEPTH    6
+#define COND_END            0x00
+#define COND_LIT8           0x01    // Push the next byte
+#define COND_LIT16          0x02    // Push the next two bytes, high first
+#define COND_REG            0x03    // Push register (index follows, COND_R_*)
+#define COND_HITS           0x04    // Push the breakpoint's hit count
+#define COND_XRAM           0x08    // Replace address on top with its XRAM byte
+#define COND_NOT            0x09    // Logical not of top
+#define COND_EQ             0x10    // Binary operators: pop b, pop a, push a op b
+#define COND_NE             0x11
+#define COND_LT             0x12
+#define COND_LE             0x13
+#define COND_GT             0x14
+#define COND_GE             0x15
+#define COND_ADD            0x20
+#define COND_SUB            0x21
+#define COND_AND            0x22
+#define COND_OR             0x23
+#define COND_XOR            0x24
+#define COND_MOD            0x25
+#define COND_LAND           0x30
+#define COND_LOR            0x31
+#define COND_R_DPTR         14      // Register indices 0-13 follow the
+#define COND_R_PC           15      // snapshot frame order (ACC ... SP)
+
+// Return address position below SP inside int1_handler(): Keil pushes
+// ACC, B, DPH, DPL, PSW and R0-R7 (13 bytes) above the interrupted PC
+#define FRAME_PCH_OFFSET    13
+#define FRAME_PCL_OFFSET    14
+
+unsigned char code hex_digits[16] = "0123456789ABCDEF";
+char code * code reg_names[DELTA_REGS] = {
+    "ACC", "B", "PSW", "DPH", "DPL", "R0", "R1", "R2", "R3", "R4", "R5", "R6", "R7", "SP"
+};
+unsigned char code coverage_bits[8] = { 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80 };
 
 //Declarations and prototype
 void uart_init();
+void run_state_init(void);
+void trans(char c);
+char typeit(void);
+unsigned char wait_rx(unsigned char ticks);
+void baud(void);
 void jump_to_user_code();
 void trans_string(const char *str);
+void trans_hex(unsigned char value);
+void send_snapshot(void);
+void show_registers(void);
+void report_registers(void);
+unsigned int delta_mask(void);
+void send_delta(void);
+void show_changes(void);
+void wait_step_command(void);
+unsigned char start_step_goal(unsigned char goal);
+unsigned char step_goal_reached(void);
+void step_engine(void);
+void capture_frame(void);
+void break_engine(void);
+void break_dump(unsigned char space);
+void cycle_calibrate(void);
+void trans_dec(unsigned long value);
+void start_user_code(unsigned char run);
+void run_to_breakpoint(void);
+void breakpoints(void);
+void list_breakpoints(void);
+unsigned char find_breakpoint(unsigned int bp_address);
+void set_condition(unsigned char n);
+unsigned char eval_condition(unsigned char n);
+unsigned int cond_register(unsigned char index);
+void watchpoints(void);
+void list_watchpoints(void);
+void watch_sync(void);
+unsigned char watch_check(void);
+unsigned char get_hex_byte(void);
+void trace(void);
+void trace_record(void);
+void trace_put(unsigned char value);
+void trace_change(unsigned char index, unsigned char value);
+void trace_download(void);
+void coverage(void);
+void coverage_clear(void);
+void coverage_mark(unsigned int pc);
+void coverage_download(void);
+void profile(void);
+void profile_sample(void);
+void profile_stop(void);
+void profile_download(void);
+void trans_dump(unsigned char value);
 void jump(void);
 void hex(void);
-int c;
-char z;
 unsigned char pc_low;
 unsigned char pc_high;
-char accbuffer[10];
-char bbuffer[10];
-char pswbuffer[10];
-char buffer[10];
-unsigned char *sp_addr;    
+unsigned char idata *sp_addr;
 unsigned int pc_value;
-unsigned int lastpc;
-unsigned int flagy;
-unsigned int FL;
-unsigned int dpl;
-unsigned int dph;
+// State kept between steps lives in XRAM: the user program's C startup
+// clears IRAM and its stack grows over the monitor's DATA and bit space,
+// which would wipe breakpoints and run flags while it is being stepped.
+// Only scratch that each step writes before reading stays in DATA.
+unsigned int xdata lastpc _at_ (XRAM_RUN_STATE + 0x1D);
+unsigned char xdata flagy _at_ XRAM_RUN_STATE;
+unsigned char xdata FL _at_ (XRAM_RUN_STATE + 0x01);
+unsigned char xdata step_binary _at_ (XRAM_RUN_STATE + 0x02);   // Snapshot frames instead of the ASCII table
+unsigned char xdata step_delta _at_ (XRAM_RUN_STATE + 0x03);    // Only the registers that changed
+unsigned char xdata delta_key _at_ (XRAM_RUN_STATE + 0x04);     // Next report is a full one (host has no state)
+unsigned char xdata delta_restart _at_ (XRAM_RUN_STATE + 0x05); // Total was reset since the last report
+unsigned char xdata delta_last[DELTA_REGS] _at_ XRAM_DELTA;
+unsigned char xdata step_running _at_ (XRAM_RUN_STATE + 0x06);  // Run mode: only check breakpoints
+unsigned char xdata step_goal _at_ (XRAM_RUN_STATE + 0x0B);     // STEP_GOAL_ of a step-over or step-out
+unsigned int xdata step_return _at_ (XRAM_RUN_STATE + 0x15);    // Step-over: address after the call
+unsigned char xdata step_sp _at_ (XRAM_RUN_STATE + 0x0C);       // Step-over: SP at the call; step-out: lowest SP
+unsigned char xdata step_goal_hit _at_ (XRAM_RUN_STATE + 0x07);
+unsigned char xdata break_armed _at_ (XRAM_RUN_STATE + 0x25);   // Serial interrupts go to break_handler()
+unsigned char xdata break_ti _at_ (XRAM_RUN_STATE + 0x26);      // User program's TI while stopped at a break
+unsigned int xdata bp_table[BP_MAX] _at_ (XRAM_RUN_STATE + 0x30);
+unsigned char xdata bp_count _at_ (XRAM_RUN_STATE + 0x0D);
+unsigned char xdata bp_hit _at_ (XRAM_RUN_STATE + 0x0E);        // 1-based table index of the breakpoint hit
+unsigned int xdata stacked_pc _at_ (XRAM_RUN_STATE + 0x17);
+unsigned int step_cycles;       // User cycles of the last instruction
+unsigned long xdata cycle_total _at_ (XRAM_RUN_STATE + 0x21);   // User cycles since the last stop
+unsigned int xdata cycle_overhead _at_ (XRAM_RUN_STATE + 0x19); // Monitor cycles the PCA sees per step
+unsigned char xdata cycle_samples _at_ (XRAM_RUN_STATE + 0x14);
+unsigned char xdata cycle_calibrating _at_ (XRAM_RUN_STATE + 0x08);
+unsigned char xdata bp_condition[BP_MAX][COND_MAX] _at_ XRAM_BP_CONDITION;
+unsigned int xdata bp_hits[BP_MAX] _at_ XRAM_BP_HITS;
+unsigned int xdata cond_stack[COND_STACK_DEPTH] _at_ XRAM_COND_STACK;
+unsigned char xdata cond_upload[COND_MAX] _at_ XRAM_COND_UPLOAD;
+unsigned char xdata watch_count _at_ (XRAM_RUN_STATE + 0x0F);
+unsigned char xdata watch_hit _at_ (XRAM_RUN_STATE + 0x10);     // 1-based watch index that changed
+unsigned char xdata watch_offset _at_ (XRAM_RUN_STATE + 0x11);  // Byte of that range, with old and new value
+unsigned char xdata watch_old _at_ (XRAM_RUN_STATE + 0x12);
+unsigned char xdata watch_new _at_ (XRAM_RUN_STATE + 0x13);
+unsigned int xdata watch_pc _at_ (XRAM_RUN_STATE + 0x1B);       // Instruction that ran before this step
+unsigned int xdata watch_start[WATCH_MAX] _at_ XRAM_WATCH;
+unsigned char xdata watch_length[WATCH_MAX] _at_ (XRAM_WATCH + 2 * WATCH_MAX);
+unsigned char xdata watch_space[WATCH_MAX] _at_ (XRAM_WATCH + 3 * WATCH_MAX);
+unsigned char xdata watch_shadow[WATCH_MAX][WATCH_LENGTH_MAX] _at_ XRAM_WATCH_SHADOW;
+unsigned char xdata trace_on _at_ (XRAM_RUN_STATE + 0x09);      // Record every run-mode step into XRAM
+unsigned char trace_changes;
+unsigned int xdata trace_magic _at_ XRAM_TRACE_STATE;
+unsigned int xdata trace_pos _at_ (XRAM_TRACE_STATE + 2);
+unsigned char xdata trace_blocks _at_ (XRAM_TRACE_STATE + 4);
+unsigned int xdata trace_prev_pc _at_ (XRAM_TRACE_STATE + 5);
+unsigned char xdata trace_last[TRACE_REGS] _at_ (XRAM_TRACE_STATE + 0x10);
+unsigned char xdata trace_buffer[TRACE_SIZE] _at_ XRAM_TRACE;
+unsigned char xdata coverage_on _at_ (XRAM_RUN_STATE + 0x0A);   // Mark every executed PC in the bitmap
+unsigned int xdata coverage_magic _at_ XRAM_COVERAGE_STATE;
+unsigned char xdata coverage_map[COVERAGE_SIZE] _at_ XRAM_COVERAGE;
+unsigned char xdata profile_armed _at_ (XRAM_RUN_STATE + 0x27); // jump() starts the profiler with the user code
+unsigned int xdata profile_magic _at_ XRAM_PROFILE_STATE;
+unsigned int xdata profile_base _at_ (XRAM_PROFILE_STATE + 2);
+unsigned char xdata profile_shift _at_ (XRAM_PROFILE_STATE + 4);
+unsigned long xdata profile_total _at_ (XRAM_PROFILE_STATE + 5);
+unsigned long xdata profile_outside _at_ (XRAM_PROFILE_STATE + 9);
+unsigned int xdata profile_hist[PROFILE_BUCKETS] _at_ XRAM_PROFILE;
+unsigned char dpl;
+unsigned char dph;
 unsigned char sp_val, acc_value, b_value, psw_value;
 unsigned int dptr_value;
 unsigned char r_values[8];
+unsigned char frame_sum;
+unsigned int dump_sum;
 unsigned char exit;
 int i;
-int j;
 unsigned char hex_string[5]; // Buffer for the 4-digit hex string
 unsigned int address = 0;
 int digit;
-unsigned int user_address;
+unsigned int xdata user_address _at_ (XRAM_RUN_STATE + 0x1F);
 void (*user_code)(void);
 char cmd;
 
 /**
- * @brief   Initializes UART communication at 9600 baud rate.
- * @details Configures Timer 1 in mode 2 for auto-reload, enabling 8-bit UART mode.
+ * @brief   Initializes UART communication on the internal baud rate generator.
+ * @details Uses BDRCON/BRL with SMOD1 so rates up to 115200 baud are
+ *          reachable. Starts at 9600 baud after a hardware reset; if the
+ *          generator is already running (rate negotiated earlier, then a
+ *          jump back to 0x0000) that rate is kept.
  * @param   None
  * @return  None
  */
 void uart_init(void) 
 {
-    TMOD |= 0x20;               // Set Timer 1 in Mode 2 (8-bit auto-reload)
-    TH1 = 0xFD;                 // Set reload value for 9600 baud rate (11.0592 MHz clock)
+    if (!(BDRCON & BDRCON_BRR)) {
+        BRL = baud_reload[0];   // 9600 baud (11.0592 MHz clock)
+    }
     SCON = 0x50;                // 8-bit UART mode, REN enabled (Receive Enable)
-    TR1 = 1;                    // Start Timer 1
+    PCON |= PCON_SMOD1;         // Double baud rate
+    BDRCON = BDRCON_BRR | BDRCON_TBCK | BDRCON_RBCK | BDRCON_SPD;
     TI = 1;                     // Set TI to indicate transmitter is ready
 }
 
+/**
+ * @brief   Clears the step and run state kept in XRAM.
+ * @details STARTUP zeroes DATA on every entry through 0x0000, but not
+ *          XRAM, so this gives the state at XRAM_RUN_STATE the same fresh
+ *          start: no breakpoints, no watchpoints, all run flags off.
+ * @param   None
+ * @return  None
+ */
+void run_state_init(void)
+{
+    unsigned char xdata *state = (unsigned char xdata *)XRAM_RUN_STATE;
+    unsigned char n;
+
+    for (n = 0; n < RUN_STATE_SIZE; n++) {
+        state[n] = 0;
+    }
+}
+
+/**
+ * @brief   Waits for a received character with a timeout.
+ * @details Uses Timer 0 in mode 1 as a 50 ms tick.
+ * @param   ticks - Number of 50 ms periods to wait.
+ * @return  1 if a character is waiting in SBUF, 0 on timeout.
+ */
+unsigned char wait_rx(unsigned char ticks)
+{
+    TMOD = (TMOD & 0xF0) | 0x01;
+    while (ticks--) {
+        TR0 = 0;
+        TH0 = 0x4C;             // 65536 - 46080 cycles = 50 ms
+        TL0 = 0x00;
+        TF0 = 0;
+        TR0 = 1;
+        while (!TF0) {
+            if (RI) {
+                TR0 = 0;
+                return 1;
+            }
+        }
+    }
+    TR0 = 0;
+    return 0;
+}
+
+/**
+ * @brief   Renegotiates the UART baud rate with the host.
+ * @details Sends "ACK <rate>" at the old rate and switches. The new rate is
+ *          kept only if the host sends 'Y' at that rate within 2 seconds;
+ *          otherwise the old rate is restored. Same handshake as the
+ *          memory editor's 'U' command.
+ * @param   None
+ * @return  None
+ */
+void baud(void)
+{
+    unsigned char choice;
+    unsigned char old_reload;
+
+    trans_string("\r\n Baud Rate (1 = 9600, 2 = 19200, 3 = 38400, 4 = 57600, 5 = 115200): ");
+    choice = typeit();
+    trans(choice);
+    if (choice < '1' || choice >= '1' + BAUD_COUNT) {
+        trans_string("\r\n Invalid Baud Rate !\r\n");
+        return;
+    }
+    choice -= '1';
+
+    trans_string("\r\n ACK ");
+    trans_string(baud_names[choice]);
+    trans_string("\r\n");
+
+    old_reload = BRL;
+    BDRCON &= ~BDRCON_BRR;
+    BRL = baud_reload[choice];
+    BDRCON |= BDRCON_BRR;
+
+    RI = 0;
+    if (wait_rx(BAUD_CONFIRM_TICKS) && typeit() == BAUD_CONFIRM_CHAR) {
+        trans_string("\r\n OK ");
+        trans_string(baud_names[choice]);
+        trans_string("\r\n");
+        return;
+    }
+
+    BDRCON &= ~BDRCON_BRR;
+    BRL = old_reload;
+    BDRCON |= BDRCON_BRR;
+    trans_string("\r\n Baud change failed, rate unchanged.\r\n");
+}
+
 /**
  * @brief   Sends a single character via UART.
  * @details Blocks until the character is transmitted via the SBUF register.
@@ -108,7 +455,6 @@ char typeit (void){
 unsigned int get_user_address()
 {
 		unsigned char bp;
-		flagy = 1;
     trans_string("\n\n\r Enter the address: ");
     for (i = 0; i < 4; i++) {
 				bp = typeit();
@@ -142,18 +488,44 @@ unsigned int get_user_address()
 }
 
 /**
- * @brief   Initiates single-step execution of user code.
- * @details Jumps to user-specified code address and executes instructions 
- *          step-by-step. On every INT1 interrupt, the register values are 
- *          displayed via UART.
- * @param   None
+ * @brief   Starts user code with INT1 armed after every instruction.
+ * @details Asks for the start address and the output mode, then calls the
+ *          user code. In single-step mode every instruction is reported; in
+ *          run mode the INT1 handler only compares the return address with
+ *          the breakpoint table and the watched ranges with their shadows,
+ *          and reports when one of them hits.
+ * @param   run - 0 for single-step mode, 1 for run mode.
  * @return  None
  */
-void jump_to_user_code() {
+void start_user_code(unsigned char run)
+{
     if (!(P3 & 0x08)){
     user_address = get_user_address();
     user_code= (void (*)(void))user_address; 
-	trans_string("\r\n\n Single-Step execution started: Press 'E' to exit!\r\n");
+	trans_string("\r\n Output (A)SCII, (B)inary, (C)hanges or (D)elta frames: ");
+	cmd = typeit();
+	trans(cmd);
+	step_binary = (cmd == 'B' || cmd == 'b' || cmd == 'D' || cmd == 'd');
+	step_delta = (cmd == 'C' || cmd == 'c' || cmd == 'D' || cmd == 'd');
+	delta_key = 1;
+	FL = 0;
+	bp_hit = 0;
+	watch_hit = 0;
+	stacked_pc = user_address;
+	watch_sync();
+	if (!run){
+		trace_on = 0;
+		coverage_on = 0;
+	}
+	flagy = !run;
+	cycle_calibrate();
+	cycle_total = 0;
+	step_running = run;
+	if (run){
+		trans_string("\r\n\n Running to breakpoint: Enter steps, 'G' continues, 'E' exits!\r\n");
+	} else {
+		trans_string("\r\n\n Single-Step execution started: Press 'E' to exit!\r\n");
+	}
 	trans_string("\r\n -----------------------------------------------\r\n");
     IT1 = 0;
     EX1 = 1;                 
@@ -165,200 +537,1732 @@ void jump_to_user_code() {
 }
 
 /**
- * @brief   Interrupt handler for INT1 to capture and display register values.
- * @details Captures the stack pointer, program counter, and register values 
- *          (ACC, B, PSW, DPTR, R0-R7) after each user instruction execution.
- *          Provides UART-based interaction for exiting single-step mode.
+ * @brief   Initiates single-step execution of user code.
+ * @details Jumps to user-specified code address and executes instructions 
+ *          step-by-step. On every INT1 interrupt, the register values are 
+ *          displayed via UART.
  * @param   None
  * @return  None
  */
+void jump_to_user_code() {
+    start_user_code(0);
+}
 
-void int1_handler() interrupt 2 {
-	
-		for (i = 0; i < 100; i++){
-			for (i = 0; i < 100; i++){}
-		}
-		TI = 1;
-		
-		
-    // Get Stack Pointer (SP)
-    sp_val = SP;
-    sp_addr = (unsigned char *)sp_val;
-		for (i = 7; i >= 0; i--) {
-        r_values[i] = *((unsigned char *)sp_addr);
-				sp_addr--;// General-purpose registers R0-R7
+/**
+ * @brief   Runs user code until it reaches a breakpoint.
+ * @details Refuses to start with an empty breakpoint table, since the code
+ *          would then run under INT1 with nothing to stop it.
+ * @param   None
+ * @return  None
+ */
+void run_to_breakpoint(void)
+{
+    unsigned char n;
+
+    if (bp_count == 0 && watch_count == 0){
+        trans_string("\r\n No breakpoints or watchpoints set, use 'B' or 'W' first.\r\n");
+        return;
     }
-		
-		psw_value = *((unsigned char *)sp_addr);   // Program Status Word
-		sp_addr--;
-		
-		dpl = *((unsigned char *)sp_addr);
-		sp_addr--;
-		dph = *((unsigned char *)sp_addr);
-		sp_addr--;
-		dptr_value = (dpl | (dph << 8)); // Data Pointer
-		
-		b_value = *((unsigned char *)sp_addr);
-		sp_addr--;
-		
-		acc_value = *((unsigned char *)sp_addr);
-		sp_addr--;
-		
-    // Get Program Counter (PC)
-		pc_high = *((unsigned char *)sp_addr);
-		sp_addr--;
-    pc_low = *((unsigned char *)sp_addr);
-    sp_addr--;
-		
-		if (flagy){
-			pc_value = user_address;
-			flagy = 0;
-		} else {
-			pc_value = lastpc;
-		}
-		lastpc = (pc_high << 8) | pc_low;
-    //pc_value = (pc_high << 8) | pc_low;
-		
-		sp_val = (unsigned char)sp_addr;
-		
-		if (FL){
-		
-		trans_string("\n\r ACC B PSW DPTR R0 R1 R2 R3 R4 R5 R6 R7 SP PC\n\r ");
-    
-    sprintf(accbuffer, "%04X ", acc_value);
-    for (i = 0; i < 2; i++) trans(accbuffer[i]);
-		trans(' ');
-    sprintf(bbuffer, "%04X ", b_value);
-    for (i = 0; i < 2; i++) trans(bbuffer[i]);
-		trans(' ');
-    sprintf(pswbuffer, "%04X ", psw_value);
-    for (i = 2; i < 4; i++) trans(pswbuffer[i]);
-		trans(' ');
-    sprintf(buffer, " %04X ", dptr_value);
-    for (i = 0; buffer[i] != '\0'; i++) trans(buffer[i]);
-
-    // Print R0-R7
-    for (i = 0; i < 8; i++) {
-        sprintf(buffer, "%02X ", r_values[i]);
-        for (j = 0; j < 2 ; j++) trans(buffer[j]);
-				trans(' ');
+    for (n = 0; n < bp_count; n++){
+        bp_hits[n] = 0;
     }
+    trace_on = 0;
+    coverage_on = 0;
+    start_user_code(1);
+}
 
-    // Print SP
-    sprintf(buffer, "%02X ", sp_val);
-    for (i = 0; i < 2; i++) trans(buffer[i]);
-		
+/**
+ * @brief   Prints the breakpoint table.
+ * @param   None
+ * @return  None
+ */
+void list_breakpoints(void)
+{
+    unsigned char n;
 
-    // Print PC
-    sprintf(buffer, " %04X", pc_value);
-    for (i = 0; buffer[i] != '\0'; i++) trans(buffer[i]);
+    trans_string("\r\n Breakpoints:");
+    for (n = 0; n < bp_count; n++){
+        trans_string("\r\n  ");
+        trans('1' + n);
+        trans_string(": ");
+        trans_hex(bp_table[n] >> 8);
+        trans_hex(bp_table[n]);
+        if (bp_condition[n][0] != COND_END){
+            trans_string(" if  hits ");
+            trans_hex(bp_hits[n] >> 8);
+            trans_hex(bp_hits[n]);
+        }
+    }
+    if (bp_count == 0){
+        trans_string(" none");
+    }
+    trans_string("\r\n");
+}
 
-		
-		while (1){
-			exit = typeit();
-			if (exit == 'E'){
-			trans('\n');
-			trans('\r');
-			EX1 = 0;                 
-			EA = 0;
-			trans_string(" -----------------------------------------------\r\n");
-			//exity();
-			break;
-			} else if ( exit == '\r'){
-					trans('\n');
-					trans('\n');
-					trans('\r');
-					break;
-				}
-		}
-    
-	} else if (lastpc == user_address){
-			FL = 1;
-	}
-    TI = 1;
+/**
+ * @brief   Looks up a breakpoint address in the table.
+ * @param   bp_address - Code address to find.
+ * @return  Table index, or bp_count if the address is not in the table.
+ */
+unsigned char find_breakpoint(unsigned int bp_address)
+{
+    unsigned char n;
+
+    for (n = 0; n < bp_count; n++){
+        if (bp_table[n] == bp_address){
+            break;
+        }
+    }
+    return n;
 }
 
 /**
- * @brief   Sends a null-terminated string via UART.
- * @details Loops through the string and transmits each character.
- * @param   str - Pointer to the string to be transmitted.
+ * @brief   Receives a condition program for breakpoint n.
+ * @details Binary upload from bp_cond: length, program bytes, and a
+ *          checksum that makes all of them sum to zero. Length 0 removes
+ *          the condition. The hit count restarts from zero. All bytes are
+ *          read even when the upload is rejected, so none are left to be
+ *          taken as commands, and the old condition is kept unless the
+ *          checksum passes.
+ * @param   n - Table index of the breakpoint.
  * @return  None
  */
-void trans_string(const char *str)
+void set_condition(unsigned char n)
 {
-    i = 0;
-    while (str[i] != '\0') // Loop until the null terminator is encountered
-    {
-        trans(str[i]);     // Call trans() for each character
-        i++;
+    unsigned char length;
+    unsigned char sum;
+    unsigned char value;
+    unsigned char k;
+
+    trans_string("\r\n Condition: ");
+    length = typeit();
+    sum = length;
+    for (k = 0; k != length; k++){
+        value = typeit();
+        sum += value;
+        if (k < COND_MAX){
+            cond_upload[k] = value;
+        }
     }
+    sum += typeit();
+    if (length >= COND_MAX || sum != 0){
+        trans_string("\r\n Condition rejected !\r\n");
+        return;
+    }
+    for (k = 0; k != length; k++){
+        bp_condition[n][k] = cond_upload[k];
+    }
+    bp_condition[n][length] = COND_END;
+    bp_hits[n] = 0;
+    trans_string("\r\n Condition set\r\n");
 }
 
 /**
- * @brief   Displays a help menu with available debugger commands.
- * @details Lists commands for memory editing, single-step execution, 
- *          and jumping to user code.
+ * @brief   Adds, deletes or clears breakpoints ('B' command).
+ * @details The table holds BP_MAX code addresses. A breakpoint stops the
+ *          program before the instruction at that address executes, or,
+ *          with a condition attached ('I'), only when the condition holds.
  * @param   None
  * @return  None
  */
-void help(void){
-	
-	 trans_string("\r\n\n ====================================\r\n\n");
-    trans_string("         AT89C51RC2 Debugger Monitor\r\n\n");
-    trans_string(" ====================================\r\n\n");
-    trans_string(" Available Commands:\r\n\n");
-    trans_string(" M - Memory Editor\r\n\n");
-    trans_string(" S - Single Step Execution\r\n\n");
-    trans_string(" J - Jump to User code\r\n\n");
-    trans_string(" H - Display This Help Menu\r\n\n");
-    trans_string(" ====================================\r\n\n");
+void breakpoints(void)
+{
+    unsigned char n;
+    unsigned char k;
+    unsigned int bp_address;
+
+    trans_string("\r\n (A)dd, (D)elete, (C)lear all, (I)f condition, (L)ist: ");
+    cmd = typeit();
+    trans(cmd);
+    switch (cmd) {
+        case 'A': case 'a':
+            if (bp_count == BP_MAX){
+                trans_string("\r\n Breakpoint table is full !\r\n");
+                return;
+            }
+            bp_address = get_user_address();
+            if (find_breakpoint(bp_address) == bp_count){
+                bp_condition[bp_count][0] = COND_END;
+                bp_hits[bp_count] = 0;
+                bp_table[bp_count++] = bp_address;
+            }
+            break;
+        case 'D': case 'd':
+            n = find_breakpoint(get_user_address());
+            if (n < bp_count){
+                // Move the last entry, with its condition, into the gap
+                bp_count--;
+                bp_table[n] = bp_table[bp_count];
+                bp_hits[n] = bp_hits[bp_count];
+                for (k = 0; k < COND_MAX; k++){
+                    bp_condition[n][k] = bp_condition[bp_count][k];
+                }
+            }
+            break;
+        case 'C': case 'c':
+            bp_count = 0;
+            break;
+        case 'I': case 'i':
+            n = find_breakpoint(get_user_address());
+            if (n == bp_count){
+                trans_string("\r\n No breakpoint at that address !\r\n");
+                return;
+            }
+            set_condition(n);
+            break;
+        case 'L': case 'l':
+            break;
+        default:
+            trans_string("\r\n Invalid Option !\r\n");
+            return;
+    }
+    list_breakpoints();
+}
+
+/**
+ * @brief   Reads a 2-digit hexadecimal byte with echo.
+ * @param   None
+ * @return  The byte value; invalid digits count as 0.
+ */
+unsigned char get_hex_byte(void)
+{
+    unsigned char value = 0;
+    unsigned char n;
+    char c;
 
+    for (n = 0; n < 2; n++){
+        c = typeit();
+        trans(c);
+        value <<= 4;
+        if (c >= '0' && c <= '9'){
+            value |= c - '0';
+        } else if (c >= 'A' && c <= 'F'){
+            value |= c - 'A' + 10;
+        } else if (c >= 'a' && c <= 'f'){
+            value |= c - 'a' + 10;
+        }
+    }
+    return value;
 }
 
 /**
- * @brief   Executes user-specified code without interrupt monitoring.
- * @details Directly jumps to the user-provided address to execute code.
+ * @brief   Prints the watchpoint table.
  * @param   None
  * @return  None
  */
-void jump(void){
-		user_address = get_user_address();
-    user_code= (void (*)(void))user_address; 
-		user_code();
+void list_watchpoints(void)
+{
+    unsigned char n;
+
+    trans_string("\r\n Watchpoints:");
+    for (n = 0; n < watch_count; n++){
+        trans_string("\r\n  ");
+        trans('1' + n);
+        trans_string(": ");
+        trans(watch_space[n]);
+        trans(':');
+        trans_hex(watch_start[n] >> 8);
+        trans_hex(watch_start[n]);
+        trans_string(" length ");
+        trans_hex(watch_length[n]);
+    }
+    if (watch_count == 0){
+        trans_string(" none");
+    }
+    trans_string("\r\n");
 }
 
 /**
- * @brief   Executes a memory hexdump starting at address 0x2000.
- * @details Performs a memory dump by calling the hexdump function 
- *          located at the specific address.
+ * @brief   Copies every watched range into its shadow.
  * @param   None
  * @return  None
  */
-void hex(void){
-	void (*hexdump)(void) = (void (*)(void))0x2000;
-	hexdump();
+void watch_sync(void)
+{
+    unsigned char n;
+    unsigned char k;
+
+    for (n = 0; n < watch_count; n++){
+        for (k = 0; k < watch_length[n]; k++){
+            if (watch_space[n] == WATCH_IRAM){
+                watch_shadow[n][k] = ((unsigned char idata *)watch_start[n])[k];
+            } else {
+                watch_shadow[n][k] = ((unsigned char xdata *)watch_start[n])[k];
+            }
+        }
+    }
+}
+
+/**
+ * @brief   Compares the watched ranges with their shadows.
+ * @details Runs on every run-mode step, so each range is compared in one
+ *          pointer loop without calls. The first changed byte is taken
+ *          over into the shadow and reported through watch_offset,
+ *          watch_old and watch_new; further changes in the same step show
+ *          up on the next one.
+ * @param   None
+ * @return  1-based index of the range that changed, or 0.
+ */
+unsigned char watch_check(void)
+{
+    unsigned char n;
+    unsigned char k;
+    unsigned char length;
+    unsigned char xdata *shadow;
+    unsigned char xdata *xram;
+    unsigned char idata *iram;
+
+    for (n = 0; n < watch_count; n++){
+        shadow = watch_shadow[n];
+        length = watch_length[n];
+        if (watch_space[n] == WATCH_IRAM){
+            iram = (unsigned char idata *)watch_start[n];
+            for (k = 0; k != length; k++){
+                if (iram[k] != shadow[k]){
+                    watch_new = iram[k];
+                    break;
+                }
+            }
+        } else {
+            xram = (unsigned char xdata *)watch_start[n];
+            for (k = 0; k != length; k++){
+                if (xram[k] != shadow[k]){
+                    watch_new = xram[k];
+                    break;
+                }
+            }
+        }
+        if (k != length){
+            watch_offset = k;
+            watch_old = shadow[k];
+            shadow[k] = watch_new;
+            return n + 1;
+        }
+    }
+    return 0;
 }
 
+/**
+ * @brief   Adds, deletes, clears or lists data watchpoints ('W' command).
+ * @details A watchpoint is an XRAM or IRAM range of up to
+ *          WATCH_LENGTH_MAX bytes. Run mode ('R') compares every range
+ *          after each instruction and stops when a byte changes,
+ *          reporting the address, old and new value and the instruction
+ *          that wrote it.
+ * @param   None
+ * @return  None
+ */
+void watchpoints(void)
+{
+    unsigned char n;
+    unsigned char k;
+    unsigned char space;
+    unsigned char length;
+    unsigned int start;
 
-void main() {
-    uart_init();
-		while(1){
-		help();
-    trans_string("\r\n Enter the Command: ");
+    trans_string("\r\n (A)dd, (D)elete, (C)lear all, (L)ist: ");
     cmd = typeit();
     trans(cmd);
-		trans_string("\033[2J\033[H");
     switch (cmd) {
-				case 'M': case 'm':
-            hex();
+        case 'A': case 'a':
+            if (watch_count == WATCH_MAX){
+                trans_string("\r\n Watchpoint table is full !\r\n");
+                return;
+            }
+            trans_string("\r\n (X)RAM or (I)RAM: ");
+            space = typeit();
+            trans(space);
+            if (space == 'x'){
+                space = WATCH_XRAM;
+            } else if (space == 'i'){
+                space = WATCH_IRAM;
+            }
+            if (space != WATCH_XRAM && space != WATCH_IRAM){
+                trans_string("\r\n Invalid Option !\r\n");
+                return;
+            }
+            start = get_user_address();
+            trans_string("\r\n Length in bytes (01-40): ");
+            length = get_hex_byte();
+            if (length == 0 || length > WATCH_LENGTH_MAX ||
+                (space == WATCH_IRAM && (start < WATCH_IRAM_FIRST || start + length > 0x100)) ||
+                (space == WATCH_XRAM && (unsigned int)(start + length - 1) < start)){
+                trans_string("\r\n Invalid Range !\r\n");
+                return;
+            }
+            watch_space[watch_count] = space;
+            watch_start[watch_count] = start;
+            watch_length[watch_count] = length;
+            watch_count++;
             break;
-        case 'S': case 's':
-            jump_to_user_code();
+        case 'D': case 'd':
+            trans_string("\r\n Watchpoint number: ");
+            n = typeit();
+            trans(n);
+            n -= '1';
+            if (n >= watch_count){
+                trans_string("\r\n No such watchpoint !\r\n");
+                return;
+            }
+            watch_count--;
+            watch_space[n] = watch_space[watch_count];
+            watch_start[n] = watch_start[watch_count];
+            watch_length[n] = watch_length[watch_count];
+            for (k = 0; k < WATCH_LENGTH_MAX; k++){
+                watch_shadow[n][k] = watch_shadow[watch_count][k];
+            }
             break;
-        case 'H': case 'h':
+        case 'C': case 'c':
+            watch_count = 0;
             break;
-				case 'J': case 'j':
-            jump();
+        case 'L': case 'l':
+            break;
+        default:
+            trans_string("\r\n Invalid Option !\r\n");
+            return;
+    }
+    list_watchpoints();
+}
+
+/**
+ * @brief   Returns a captured register for the condition bytecode.
+ * @param   index - 0-13 in snapshot frame order, COND_R_DPTR or COND_R_PC.
+ * @return  Register value.
+ */
+unsigned int cond_register(unsigned char index)
+{
+    switch (index) {
+        case 0:  return acc_value;
+        case 1:  return b_value;
+        case 2:  return psw_value;
+        case 3:  return dph;
+        case 4:  return dpl;
+        case 13: return sp_val;
+        case COND_R_DPTR: return dptr_value;
+        case COND_R_PC:   return lastpc;
+        default: break;
+    }
+    if (index >= 5 && index < 13){
+        return r_values[index - 5];
+    }
+    return 0;
+}
+
+/**
+ * @brief   Runs the condition program of breakpoint n on the captured
+ *          registers.
+ * @details Called from int1_handler() on every pass over the breakpoint,
+ *          so a hit count or register test is decided on the target
+ *          without any UART traffic. A malformed program stops the
+ *          program rather than silently never firing.
+ * @param   n - Table index of the breakpoint.
+ * @return  Non-zero if the program should stop here.
+ */
+unsigned char eval_condition(unsigned char n)
+{
+    unsigned char xdata *code_ptr = bp_condition[n];
+    unsigned char xdata *code_end = code_ptr + COND_MAX;
+    unsigned char depth = 0;
+    unsigned char op;
+    unsigned int a;
+    unsigned int b;
+
+    if (*code_ptr == COND_END){
+        return 1;               // Unconditional breakpoint
+    }
+    while (code_ptr < code_end){
+        op = *code_ptr++;
+        if (op == COND_END){
+            return depth == 0 || cond_stack[depth - 1] != 0;
+        }
+        if (op < COND_XRAM){
+            if (depth == COND_STACK_DEPTH){
+                return 1;
+            }
+            switch (op) {
+                case COND_LIT8:  a = *code_ptr++; break;
+                case COND_LIT16: a = *code_ptr++ << 8; a |= *code_ptr++; break;
+                case COND_REG:   a = cond_register(*code_ptr++); break;
+                case COND_HITS:  a = bp_hits[n]; break;
+                default:         return 1;
+            }
+            cond_stack[depth++] = a;
+        } else if (op < COND_EQ){
+            if (depth == 0){
+                return 1;
+            }
+            a = cond_stack[depth - 1];
+            cond_stack[depth - 1] = (op == COND_XRAM) ? *(unsigned char xdata *)a : !a;
+        } else {
+            if (depth < 2){
+                return 1;
+            }
+            b = cond_stack[--depth];
+            a = cond_stack[depth - 1];
+            switch (op) {
+                case COND_EQ:   a = (a == b); break;
+                case COND_NE:   a = (a != b); break;
+                case COND_LT:   a = (a < b); break;
+                case COND_LE:   a = (a <= b); break;
+                case COND_GT:   a = (a > b); break;
+                case COND_GE:   a = (a >= b); break;
+                case COND_ADD:  a = a + b; break;
+                case COND_SUB:  a = a - b; break;
+                case COND_AND:  a = a & b; break;
+                case COND_OR:   a = a | b; break;
+                case COND_XOR:  a = a ^ b; break;
+                case COND_MOD:  a = b ? a % b : 0; break;
+                case COND_LAND: a = (a && b); break;
+                case COND_LOR:  a = (a || b); break;
+                default:        return 1;
+            }
+            cond_stack[depth - 1] = a;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief   Appends one byte to the trace ring.
+ * @param   value - Byte to store.
+ * @return  None
+ */
+void trace_put(unsigned char value)
+{
+    trace_buffer[trace_pos++] = value;
+}
+
+/**
+ * @brief   Adds an index/value pair to the current trace record if the
+ *          register changed since the previous step.
+ * @param   index - Register position in snapshot frame order.
+ * @param   value - Current register value.
+ * @return  None
+ */
+void trace_change(unsigned char index, unsigned char value)
+{
+    if (trace_last[index] != value){
+        trace_last[index] = value;
+        trace_put(index);
+        trace_put(value);
+        trace_changes++;
+    }
+}
+
+/**
+ * @brief   Records the registers captured by int1_handler() in the trace.
+ * @details Writes a keyframe at the start of each block and otherwise only
+ *          the registers that changed, so a typical instruction costs one
+ *          to three bytes and the 4 KB ring holds the last couple of
+ *          thousand steps.
+ * @param   None
+ * @return  None
+ */
+void trace_record(void)
+{
+    unsigned int ctrl_pos;
+    unsigned int pc_step;
+    unsigned char ctrl;
+    unsigned char n;
+
+    if ((unsigned char)trace_pos > TRACE_BLOCK_SIZE - TRACE_RECORD_MAX){
+        trace_pos = ((trace_pos | (TRACE_BLOCK_SIZE - 1)) + 1) & (TRACE_SIZE - 1);
+    }
+
+    if ((unsigned char)trace_pos == 0){
+        if (trace_blocks < TRACE_BLOCKS){
+            trace_blocks++;
+        }
+        trace_put(TRACE_KEYFRAME);
+        trace_put(trace_last[0] = acc_value);
+        trace_put(trace_last[1] = b_value);
+        trace_put(trace_last[2] = psw_value);
+        trace_put(trace_last[3] = dph);
+        trace_put(trace_last[4] = dpl);
+        for (n = 0; n < 8; n++){
+            trace_put(trace_last[5 + n] = r_values[n]);
+        }
+        trace_put(trace_last[13] = sp_val);
+        trace_put(pc_high);
+        trace_put(pc_low);
+    } else {
+        ctrl_pos = trace_pos++;
+        pc_step = lastpc - trace_prev_pc;
+        if (pc_step != 0 && pc_step < 4){
+            ctrl = (unsigned char)pc_step << 5;
+        } else {
+            ctrl = TRACE_PC_ABS;
+            trace_put(pc_high);
+            trace_put(pc_low);
+        }
+        if (acc_value != trace_last[0]){
+            trace_last[0] = acc_value;
+            trace_put(acc_value);
+            ctrl |= TRACE_ACC;
+        }
+        trace_changes = 0;
+        trace_change(1, b_value);
+        if ((psw_value ^ trace_last[2]) & 0xFE){
+            trace_change(2, psw_value);
+        }
+        trace_last[2] = psw_value;
+        trace_change(3, dph);
+        trace_change(4, dpl);
+        for (n = 0; n < 8; n++){
+            trace_change(5 + n, r_values[n]);
+        }
+        trace_change(13, sp_val);
+        trace_buffer[ctrl_pos] = ctrl | trace_changes;
+    }
+    trace_prev_pc = lastpc;
+
+    trace_pos &= TRACE_SIZE - 1;
+    if ((unsigned char)trace_pos != 0){
+        trace_buffer[trace_pos] = TRACE_END;
+    }
+}
+
+/**
+ * @brief   Sends the trace ring to the host, oldest block first.
+ * @details Format: TRACE_DUMP_SYNC, block count, the blocks, and a 16-bit
+ *          sum of the block bytes (high byte first). Decoded by
+ *          Host_Tools/trace_dump. The ring survives a reset, so a trace
+ *          that ended in a crash can be read back afterwards.
+ * @param   None
+ * @return  None
+ */
+void trace_download(void)
+{
+    unsigned int sum = 0;
+    unsigned int pos;
+    unsigned int count;
+    unsigned char value;
+
+    if (trace_magic != TRACE_MAGIC || trace_blocks == 0){
+        trans_string("\r\n No trace recorded.\r\n");
+        return;
+    }
+    if (trace_blocks < TRACE_BLOCKS){
+        pos = 0;
+    } else {
+        // The block after the one being written holds the oldest steps
+        pos = (trace_pos + TRACE_BLOCK_SIZE - 1) & ~(TRACE_BLOCK_SIZE - 1);
+    }
+    trans_string("\r\n");
+    trans(TRACE_DUMP_SYNC);
+    trans(trace_blocks);
+    for (count = (unsigned int)trace_blocks * TRACE_BLOCK_SIZE; count != 0; count--){
+        pos &= TRACE_SIZE - 1;
+        value = trace_buffer[pos++];
+        sum += value;
+        trans(value);
+    }
+    trans(sum >> 8);
+    trans(sum);
+    trans_string("\r\n");
+}
+
+/**
+ * @brief   Starts a traced run or downloads the trace ('T' command).
+ * @details A traced run is run mode that also records every step; it
+ *          still stops at breakpoints. Tracing is slower than plain run
+ *          mode because all registers are captured on each step.
+ * @param   None
+ * @return  None
+ */
+void trace(void)
+{
+    trans_string("\r\n (R)un with trace, (D)ownload trace: ");
+    cmd = typeit();
+    trans(cmd);
+    switch (cmd) {
+        case 'R': case 'r':
+            trace_magic = TRACE_MAGIC;
+            trace_pos = 0;
+            trace_blocks = 0;
+            coverage_on = 0;
+            trace_on = 1;
+            start_user_code(1);
+            break;
+        case 'D': case 'd':
+            trace_download();
+            break;
+        default:
+            trans_string("\r\n Invalid Option !\r\n");
+            break;
+    }
+}
+
+/**
+ * @brief   Clears the coverage bitmap.
+ * @param   None
+ * @return  None
+ */
+void coverage_clear(void)
+{
+    unsigned int n;
+
+    for (n = 0; n < COVERAGE_SIZE; n++){
+        coverage_map[n] = 0;
+    }
+    coverage_magic = COVERAGE_MAGIC;
+}
+
+/**
+ * @brief   Marks a code address as executed.
+ * @details Called from the INT1 handler on every step of a coverage run,
+ *          so it only sets the bit; addresses outside COVERAGE_BASE to
+ *          COVERAGE_BASE + COVERAGE_SPAN - 1 are ignored.
+ * @param   pc - Address of the instruction about to run.
+ * @return  None
+ */
+void coverage_mark(unsigned int pc)
+{
+    pc -= COVERAGE_BASE;
+    if (pc < COVERAGE_SPAN){
+        coverage_map[pc >> 3] |= coverage_bits[pc & 7];
+    }
+}
+
+/**
+ * @brief   Sends the coverage bitmap to the host.
+ * @details Format: COVERAGE_DUMP_SYNC, base (2), bitmap size (2), the
+ *          bitmap, and a 16-bit sum of all bytes after the sync, high
+ *          bytes first. Decoded by Host_Tools/cov_view.
+ * @param   None
+ * @return  None
+ */
+void coverage_download(void)
+{
+    unsigned int n;
+
+    if (coverage_magic != COVERAGE_MAGIC){
+        trans_string("\r\n No coverage recorded.\r\n");
+        return;
+    }
+    trans_string("\r\n");
+    trans(COVERAGE_DUMP_SYNC);
+    dump_sum = 0;
+    trans_dump(COVERAGE_BASE >> 8);
+    trans_dump(COVERAGE_BASE & 0xFF);
+    trans_dump(COVERAGE_SIZE >> 8);
+    trans_dump(COVERAGE_SIZE & 0xFF);
+    for (n = 0; n < COVERAGE_SIZE; n++){
+        trans_dump(coverage_map[n]);
+    }
+    trans(dump_sum >> 8);
+    trans(dump_sum);
+    trans_string("\r\n");
+}
+
+/**
+ * @brief   Starts a coverage run, clears or downloads the bitmap ('C').
+ * @details A coverage run is run mode that also marks every executed
+ *          address. The bitmap accumulates over runs until it is
+ *          cleared, so several test sessions can be merged; like the
+ *          trace it survives a reset of the board.
+ * @param   None
+ * @return  None
+ */
+void coverage(void)
+{
+    trans_string("\r\n (R)un with coverage, (C)lear, (D)ownload coverage: ");
+    cmd = typeit();
+    trans(cmd);
+    switch (cmd) {
+        case 'R': case 'r':
+            if (coverage_magic != COVERAGE_MAGIC){
+                coverage_clear();
+            }
+            trace_on = 0;
+            coverage_on = 1;
+            start_user_code(1);
+            break;
+        case 'C': case 'c':
+            coverage_clear();
+            trans_string("\r\n Coverage cleared.\r\n");
+            break;
+        case 'D': case 'd':
+            coverage_download();
+            break;
+        default:
+            trans_string("\r\n Invalid Option !\r\n");
+            break;
+    }
+}
+
+/**
+ * @brief   Interrupt handler for INT1 to capture and report register values.
+ * @details Stops the PCA while the monitor runs, so the counter only sees
+ *          the user instruction plus a fixed entry/exit path that
+ *          cycle_calibrate() measures, then hands over to step_engine().
+ *          Because this handler calls functions, Keil pushes ACC, B, DPH,
+ *          DPL, PSW and R0-R7 on entry; the frame is read back from SP in
+ *          that order.
+ * @param   None
+ * @return  None
+ */
+
+void int1_handler() interrupt 2 {
+    CR = 0;
+    step_cycles = (CH << 8) | CL;
+
+    // Get Stack Pointer (SP)
+    sp_addr = (unsigned char idata *)SP;
+    step_engine();
+
+    CH = 0;
+    CL = 0;
+    CR = 1;
+}
+
+/**
+ * @brief   Measures the monitor's share of the PCA count per step.
+ * @details Single-steps a few NOPs (one cycle each) with the engine in
+ *          calibration mode and keeps the smallest count, ignoring the
+ *          first step whose start was not timed by the handler.
+ * @param   None
+ * @return  None
+ */
+void cycle_calibrate(void)
+{
+    CMOD = 0x00;
+    CH = 0;
+    CL = 0;
+    cycle_overhead = 0xFFFF;
+    cycle_samples = 0;
+    cycle_calibrating = 1;
+    IT1 = 0;
+    EX1 = 1;
+    EA = 1;
+    _nop_();
+    _nop_();
+    _nop_();
+    _nop_();
+    _nop_();
+    _nop_();
+    EA = 0;
+    cycle_calibrating = 0;
+    cycle_overhead--;           // Less the NOP itself
+}
+
+/**
+ * @brief   Handles one INT1 step: breakpoints, trace and reporting.
+ * @details Runs with sp_addr pointing at the frame pushed by
+ *          int1_handler(). Every return path goes back through the
+ *          handler, so the PCA restarts at the same point each time.
+ * @param   None
+ * @return  None
+ */
+void step_engine(void)
+{
+		unsigned char n;
+
+    if (cycle_calibrating){
+        if (cycle_samples++ != 0 && step_cycles < cycle_overhead){
+            cycle_overhead = step_cycles;
+        }
+        return;
+    }
+    step_cycles -= cycle_overhead;
+    cycle_total += step_cycles;
+
+    // The return address is the next instruction the user program runs;
+    // the previous one is the instruction that just ran
+    watch_pc = stacked_pc;
+    stacked_pc = (sp_addr[-FRAME_PCH_OFFSET] << 8) | sp_addr[-FRAME_PCL_OFFSET];
+    if (coverage_on){
+        coverage_mark(stacked_pc);
+    }
+
+    // Run mode: compare the return address with the breakpoint table and
+    // go straight back to the user program on a miss
+    if (step_running){
+        for (n = bp_count; n != 0; n--) {
+            if (bp_table[n - 1] == stacked_pc){
+                break;
+            }
+        }
+        if (n != 0){
+            step_running = 0;
+            bp_hit = n;
+        } else if (watch_count != 0 && (watch_hit = watch_check()) != 0){
+            step_running = 0;
+        } else if (step_goal != STEP_GOAL_NONE && step_goal_reached()){
+            step_running = 0;
+            step_goal = STEP_GOAL_NONE;
+            step_goal_hit = 1;
+        } else if (!trace_on){
+            return;
+        }
+    }
+
+		capture_frame();
+		
+		if (flagy){
+			pc_value = user_address;
+			flagy = 0;
+		} else {
+			pc_value = lastpc;
+		}
+		lastpc = (pc_high << 8) | pc_low;
+
+		if (trace_on){
+			trace_record();
+			if (step_running){
+				return;
+			}
+		}
+		
+		if (bp_hit){
+			bp_hits[bp_hit - 1]++;
+			if (!eval_condition(bp_hit - 1)){
+				// Condition false: back to run mode without a word on the UART
+				bp_hit = 0;
+				step_running = 1;
+				return;
+			}
+			// Stopped before the breakpoint instruction; stepping goes on from here
+			pc_value = lastpc;
+			FL = 1;
+			if (!step_binary){
+				trans_string("\n\r Breakpoint ");
+				trans('0' + bp_hit);
+			}
+			report_registers();
+			// Cycles between two breakpoints are counted from here
+			cycle_total = 0;
+			delta_restart = 1;
+			bp_hit = 0;
+			wait_step_command();
+	} else if (watch_hit){
+			pc_value = lastpc;
+			FL = 1;
+			if (!step_binary){
+				trans_string("\n\r Watch ");
+				trans('0' + watch_hit);
+				trans_string(": ");
+				trans(watch_space[watch_hit - 1]);
+				trans(':');
+				n = watch_hit - 1;
+				trans_hex((watch_start[n] + watch_offset) >> 8);
+				trans_hex(watch_start[n] + watch_offset);
+				trans(' ');
+				trans_hex(watch_old);
+				trans_string(" -> ");
+				trans_hex(watch_new);
+				trans_string(" by PC ");
+				trans_hex(watch_pc >> 8);
+				trans_hex(watch_pc);
+			}
+			report_registers();
+			cycle_total = 0;
+			delta_restart = 1;
+			watch_hit = 0;
+			wait_step_command();
+	} else if (step_goal_hit){
+			// Stopped after the call or return, like at a breakpoint
+			pc_value = lastpc;
+			FL = 1;
+			step_goal_hit = 0;
+			report_registers();
+			wait_step_command();
+	} else if (FL){
+			report_registers();
+			wait_step_command();
+	} else if (lastpc == user_address){
+			FL = 1;
+			cycle_total = 0;        // Start counting at the first user instruction
+	}
+    // The user program may be polling TI for its own output
+    TI = 1;
+}
+
+/**
+ * @brief   Reads the user registers from an interrupt frame.
+ * @details Walks down from sp_addr through the 13 registers Keil pushes
+ *          and the interrupted PC; sp_val ends up as the user program's SP.
+ * @param   None
+ * @return  None
+ */
+void capture_frame(void)
+{
+    unsigned char n;
+
+    for (n = 8; n != 0; n--) {
+        r_values[n - 1] = *sp_addr--;   // General-purpose registers R7-R0
+    }
+    psw_value = *sp_addr--;   // Program Status Word
+    dpl = *sp_addr--;
+    dph = *sp_addr--;
+    dptr_value = (dpl | (dph << 8)); // Data Pointer
+    b_value = *sp_addr--;
+    acc_value = *sp_addr--;
+
+    // Get Program Counter (PC)
+    pc_high = *sp_addr--;
+    pc_low = *sp_addr--;
+    sp_val = (unsigned char)sp_addr;
+}
+
+/**
+ * @brief   Sends one byte and adds it to the snapshot checksum.
+ * @param   value - Byte to transmit.
+ * @return  None
+ */
+static void trans_sum(unsigned char value)
+{
+    trans(value);
+    frame_sum += value;
+}
+
+/**
+ * @brief   Sends the captured registers as a binary snapshot frame.
+ * @details Frame: STEP_FRAME_SYNC, ACC, B, PSW, DPH, DPL, R0-R7, SP, PCH,
+ *          PCL, the user cycles of the step (2 bytes) and since the last
+ *          stop (4 bytes), high bytes first, and a checksum. The checksum
+ *          makes the 22 data bytes plus itself sum to zero, so the host
+ *          can resynchronise if user program output is mixed into the
+ *          stream. 24 bytes per step against about 75 for the ASCII table.
+ * @param   None
+ * @return  None
+ */
+void send_snapshot(void)
+{
+    unsigned char n;
+
+    trans(STEP_FRAME_SYNC);
+    frame_sum = 0;
+    trans_sum(acc_value);
+    trans_sum(b_value);
+    trans_sum(psw_value);
+    trans_sum(dph);
+    trans_sum(dpl);
+    for (n = 0; n < 8; n++) {
+        trans_sum(r_values[n]);
+    }
+    trans_sum(sp_val);
+    trans_sum(pc_value >> 8);
+    trans_sum(pc_value);
+    trans_sum(step_cycles >> 8);
+    trans_sum(step_cycles);
+    trans_sum(cycle_total >> 24);
+    trans_sum(cycle_total >> 16);
+    trans_sum(cycle_total >> 8);
+    trans_sum(cycle_total);
+    trans(-frame_sum);
+}
+
+/**
+ * @brief   Compares the captured registers with the last reported ones.
+ * @details PSW.P is left out of the comparison: it always follows ACC and
+ *          the host recomputes it, so an ACC change does not drag PSW
+ *          along. The captured values become the new reference.
+ * @param   None
+ * @return  Bit n set for each register n (DELTA_REGS order) that changed.
+ */
+unsigned int delta_mask(void)
+{
+    unsigned int mask = 0;
+    unsigned int bit_value = 1;
+    unsigned char value;
+    unsigned char n;
+
+    for (n = 0; n < DELTA_REGS; n++) {
+        value = cond_register(n);
+        if (n == 2){
+            value &= ~PSW_PARITY;
+        }
+        if (value != delta_last[n]){
+            mask |= bit_value;
+            delta_last[n] = value;
+        }
+        bit_value <<= 1;
+    }
+    return mask;
+}
+
+/**
+ * @brief   Sends the registers that changed as a binary delta frame.
+ * @details Frame: DELTA_FRAME_SYNC, mask (2 bytes, DELTA_REGS bits plus
+ *          DELTA_TOTAL_RESTART), the changed registers in mask order, PCH,
+ *          PCL, the user cycles of the step (1 byte, saturated) and a
+ *          checksum as in send_snapshot(). Typical steps change ACC or one
+ *          Rn, which makes 7-8 bytes against 24 for a full snapshot. The
+ *          host keeps the full state and adds up the total cycles.
+ * @param   None
+ * @return  None
+ */
+void send_delta(void)
+{
+    unsigned int mask = delta_mask();
+    unsigned int bit_value = 1;
+    unsigned char n;
+
+    if (delta_restart){
+        mask |= DELTA_TOTAL_RESTART;
+    }
+    trans(DELTA_FRAME_SYNC);
+    frame_sum = 0;
+    trans_sum(mask >> 8);
+    trans_sum(mask);
+    for (n = 0; n < DELTA_REGS; n++) {
+        if (mask & bit_value){
+            trans_sum(cond_register(n));
+        }
+        bit_value <<= 1;
+    }
+    trans_sum(pc_value >> 8);
+    trans_sum(pc_value);
+    trans_sum(step_cycles > 0xFF ? 0xFF : step_cycles);
+    trans(-frame_sum);
+}
+
+/**
+ * @brief   Prints the PC, the step cycles and the registers that changed.
+ * @details ASCII counterpart of send_delta(), e.g. " 40A3  2  ACC=11 R7=05".
+ * @param   None
+ * @return  None
+ */
+void show_changes(void)
+{
+    unsigned int mask = delta_mask();
+    unsigned int bit_value = 1;
+    unsigned char n;
+
+    trans_string("\n\r ");
+    trans_hex(pc_value >> 8);
+    trans_hex(pc_value);
+    trans_string("  ");
+    trans_dec(step_cycles);
+    trans(' ');
+    for (n = 0; n < DELTA_REGS; n++) {
+        if (mask & bit_value){
+            trans(' ');
+            trans_string(reg_names[n]);
+            trans('=');
+            trans_hex(cond_register(n));
+        }
+        bit_value <<= 1;
+    }
+}
+
+/**
+ * @brief   Reports the captured registers in the chosen output mode.
+ * @details In the delta modes the first report after a start or a silent
+ *          run is a full one, so the host has a complete state to apply
+ *          the following deltas to.
+ * @param   None
+ * @return  None
+ */
+void report_registers(void)
+{
+    if (step_delta && !delta_key){
+        if (step_binary){
+            send_delta();
+        } else {
+            show_changes();
+        }
+    } else {
+        delta_mask();
+        if (step_binary){
+            send_snapshot();
+        } else {
+            show_registers();
+        }
+    }
+    delta_key = 0;
+    delta_restart = 0;
+}
+
+/**
+ * @brief   Sends a byte as two hexadecimal digits.
+ * @param   value - Byte to print.
+ * @return  None
+ */
+void trans_hex(unsigned char value)
+{
+    trans(hex_digits[value >> 4]);
+    trans(hex_digits[value & 0x0F]);
+}
+
+/**
+ * @brief   Prints the captured registers as one row of the ASCII table.
+ * @details Uses a digit lookup instead of sprintf; step_view renders the
+ *          binary frames with the same layout.
+ * @param   None
+ * @return  None
+ */
+void show_registers(void)
+{
+    unsigned char n;
+
+    trans_string("\n\r ACC B  PSW DPTR R0 R1 R2 R3 R4 R5 R6 R7 SP PC   CY TOTAL\n\r ");
+    trans_hex(acc_value);
+    trans_string("  ");
+    trans_hex(b_value);
+    trans(' ');
+    trans_hex(psw_value);
+    trans_string("  ");
+    trans_hex(dph);
+    trans_hex(dpl);
+    for (n = 0; n < 8; n++) {
+        trans(' ');
+        trans_hex(r_values[n]);
+    }
+    trans(' ');
+    trans_hex(sp_val);
+    trans(' ');
+    trans_hex(pc_value >> 8);
+    trans_hex(pc_value);
+    trans_string("  ");
+    trans_dec(step_cycles);
+    trans(' ');
+    trans_dec(cycle_total);
+}
+
+/**
+ * @brief   Sends an unsigned number in decimal.
+ * @param   value - Number to print.
+ * @return  None
+ */
+void trans_dec(unsigned long value)
+{
+    unsigned char digits[10];
+    unsigned char n = 0;
+
+    do {
+        digits[n++] = '0' + (unsigned char)(value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (n != 0) {
+        trans(digits[--n]);
+    }
+}
+
+/**
+ * @brief   Checks whether a step-over or step-out has arrived.
+ * @details Step-over stops when the return address of the call comes back
+ *          as the next PC at the SP the call was made with, so recursive
+ *          calls of the same function do not end it early. Step-out keeps
+ *          the lowest SP seen so far and stops after a RET that leaves SP
+ *          below it: returns from deeper calls only get back to an SP that
+ *          was already seen. Both run on the silent run-mode path.
+ * @param   None
+ * @return  1 when the goal is reached, 0 otherwise.
+ */
+unsigned char step_goal_reached(void)
+{
+    unsigned char user_sp = (unsigned char)sp_addr - FRAME_PCL_OFFSET - 1;
+
+    if (step_goal == STEP_GOAL_OVER){
+        return stacked_pc == step_return && user_sp == step_sp;
+    }
+    if (*(unsigned char code *)watch_pc == OP_RET && user_sp < step_sp){
+        return 1;
+    }
+    if (user_sp < step_sp){
+        step_sp = user_sp;
+    }
+    return 0;
+}
+
+/**
+ * @brief   Sets up a step-over or step-out from the current stop.
+ * @details The opcode at the next PC is read from code memory: step-over
+ *          of anything but LCALL/ACALL is a plain step.
+ * @param   goal - STEP_GOAL_OVER or STEP_GOAL_OUT.
+ * @return  1 if the program should run silently, 0 for a plain step.
+ */
+unsigned char start_step_goal(unsigned char goal)
+{
+    unsigned char opcode = *(unsigned char code *)lastpc;
+
+    if (goal == STEP_GOAL_OVER){
+        if (opcode == OP_LCALL){
+            step_return = lastpc + 3;
+        } else if ((opcode & OP_ACALL_MASK) == OP_ACALL){
+            step_return = lastpc + 2;
+        } else {
+            return 0;
+        }
+    }
+    step_goal = goal;
+    step_sp = sp_val;
+    return 1;
+}
+
+/**
+ * @brief   Waits for the next single-step command.
+ * @details Enter executes the next instruction, 'N' steps over a call,
+ *          'F' runs until the current function returns, 'G' runs on to the
+ *          next breakpoint and 'E' leaves single-step mode and lets the
+ *          user program run freely.
+ * @param   None
+ * @return  None
+ */
+void wait_step_command(void)
+{
+		step_goal = STEP_GOAL_NONE;
+		while (1){
+			exit = typeit();
+			if ((exit == 'N' || exit == 'F') &&
+			    start_step_goal(exit == 'N' ? STEP_GOAL_OVER : STEP_GOAL_OUT)){
+				FL = 0;
+				delta_key = 1;
+				watch_sync();
+				step_running = 1;
+				break;
+			} else if (exit == 'N'){
+				exit = '\r';            // Not a call: same as a single step
+			}
+			if (exit == 'E'){
+			EX1 = 0;                 
+			EA = 0;
+			if (!step_binary){
+				trans('\n');
+				trans('\r');
+				trans_string(" -----------------------------------------------\r\n");
+			}
+			break;
+			} else if (exit == 'G' && (bp_count != 0 || watch_count != 0 || trace_on || coverage_on)){
+				FL = 0;
+				delta_key = 1;          // Steps run silently until the next stop
+				watch_sync();           // Changes made while stepping are not hits
+				step_running = 1;
+				if (!step_binary){
+					trans_string("\n\r Running\n\r");
+				}
+				break;
+			} else if ( exit == '\r'){
+				if (!step_binary){
+					trans('\n');
+					trans('\n');
+					trans('\r');
+				}
+				break;
+			}
+		}
+}
+
+/**
+ * @brief   Sends a null-terminated string via UART.
+ * @details Loops through the string and transmits each character.
+ * @param   str - Pointer to the string to be transmitted.
+ * @return  None
+ */
+void trans_string(const char *str)
+{
+    i = 0;
+    while (str[i] != '\0') // Loop until the null terminator is encountered
+    {
+        trans(str[i]);     // Call trans() for each character
+        i++;
+    }
+}
+
+/**
+ * @brief   Displays a help menu with available debugger commands.
+ * @details Lists commands for memory editing, single-step execution, 
+ *          and jumping to user code.
+ * @param   None
+ * @return  None
+ */
+void help(void){
+	
+	 trans_string("\r\n\n ====================================\r\n\n");
+    trans_string("         AT89C51RC2 Debugger Monitor\r\n\n");
+    trans_string(" ====================================\r\n\n");
+    trans_string(" Available Commands:\r\n\n");
+    trans_string(" M - Memory Editor\r\n\n");
+    trans_string(" S - Single Step Execution\r\n\n");
+    trans_string(" B - Set or Clear Breakpoints\r\n\n");
+    trans_string(" W - Set or Clear Data Watchpoints\r\n\n");
+    trans_string(" R - Run to Breakpoint or Watchpoint\r\n\n");
+    trans_string(" T - Trace Run / Download Trace\r\n\n");
+    trans_string(" P - Profile User Code / Download Profile\r\n\n");
+    trans_string(" C - Coverage Run / Download Coverage\r\n\n");
+    trans_string(" J - Jump to User code (Ctrl-C breaks in)\r\n\n");
+    trans_string(" U - Change UART Baud Rate\r\n\n");
+    trans_string(" H - Display This Help Menu\r\n\n");
+    trans_string(" ====================================\r\n\n");
+
+}
+
+/**
+ * @brief   Executes user-specified code without interrupt monitoring.
+ * @details Directly jumps to the user-provided address to execute code.
+ *          When the profiler is armed, Timer 0 sampling starts just
+ *          before the call and stops if the user code returns; otherwise
+ *          the serial interrupt is armed so Ctrl-C breaks in.
+ * @param   None
+ * @return  None
+ */
+void jump(void){
+		user_address = get_user_address();
+    user_code= (void (*)(void))user_address; 
+		if (profile_armed){
+			profile_base = user_address;
+			trans_string("\r\n Profiling, send ESC to stop\r\n");
+			TMOD = (TMOD & 0xF0) | 0x01;
+			TH0 = PROFILE_RELOAD >> 8;
+			TL0 = PROFILE_RELOAD & 0xFF;
+			TF0 = 0;
+			ET0 = 1;
+			EA = 1;
+			TR0 = 1;
+		} else {
+			// Ctrl-C breaks in; calibrate now in case stepping follows
+			if (!(P3 & 0x08)){
+				cycle_calibrate();
+			}
+			trans_string("\r\n Running, Ctrl-C breaks in\r\n");
+			RI = 0;
+			break_armed = 1;
+			ES = 1;
+			EA = 1;
+		}
+		user_code();
+		ES = 0;
+		break_armed = 0;
+		if (profile_armed){
+			profile_stop();
+			trans_string("\r\n Profile complete\r\n");
+		}
+}
+
+/**
+ * @brief   Serial interrupt handler while a 'J' program runs.
+ * @details vectors.a51 sends the serial interrupt here only while
+ *          break_armed is set; otherwise it belongs to the memory editor.
+ *          The frame is the same as in int1_handler().
+ * @param   None
+ * @return  None
+ */
+void break_handler() interrupt 4 {
+    sp_addr = (unsigned char idata *)SP;
+    break_engine();
+}
+
+/**
+ * @brief   Dumps BREAK_DUMP_LENGTH bytes of XRAM or IRAM.
+ * @param   space - 'X' for XRAM (4-digit address) or 'I' for IRAM (2 digits).
+ * @return  None
+ */
+void break_dump(unsigned char space)
+{
+    unsigned int start;
+    unsigned char n;
+
+    if (space == 'X'){
+        start = get_user_address();
+    } else {
+        trans_string("\r\n Enter the address: ");
+        start = get_hex_byte();
+    }
+    trans_string("\r\n ");
+    for (n = 0; n < BREAK_DUMP_LENGTH; n++){
+        if (space == 'X'){
+            trans_hex(((unsigned char xdata *)start)[n]);
+        } else {
+            trans_hex(((unsigned char idata *)0)[(unsigned char)(start + n)]);
+        }
+        trans(' ');
+    }
+    trans_string("\r\n");
+}
+
+/**
+ * @brief   Stops a running program on Ctrl-C.
+ * @details A transmit-complete interrupt or any other received byte is
+ *          left to the user program. On a break the registers are shown
+ *          and the program waits inside the handler: 'G' resumes it,
+ *          'S' leaves it stopped under INT1 single-stepping from the same
+ *          instruction, 'X'/'I' dump memory and 'Q' returns to the
+ *          monitor by rewriting the stacked PC to 0x0000, which keeps
+ *          XRAM intact.
+ * @param   None
+ * @return  None
+ */
+void break_engine(void)
+{
+    if (!RI || SBUF != BREAK_CHAR){
+        return;
+    }
+    RI = 0;
+    break_ti = TI;
+    capture_frame();
+    lastpc = (pc_high << 8) | pc_low;
+    pc_value = lastpc;
+    step_cycles = 0;
+    cycle_total = 0;
+    step_binary = 0;
+    step_delta = 0;
+    trans_string("\n\r Break");
+    show_registers();
+
+    while (1){
+        trans_string("\r\n\n (G)o, (S)tep, (X)RAM or (I)RAM dump, (Q)uit to monitor: ");
+        cmd = typeit();
+        trans(cmd);
+        switch (cmd) {
+            case 'G': case 'g':
+                TI = break_ti;
+                return;
+            case 'S': case 's':
+                if (P3 & 0x08){
+                    trans_string("\r\n P3.3 (INT1) is not connected to low!");
+                    break;
+                }
+                // The next INT1 reports the instruction at the break PC
+                ES = 0;
+                break_armed = 0;
+                FL = 1;
+                flagy = 0;
+                step_running = 0;
+                trace_on = 0;
+                coverage_on = 0;
+                bp_hit = 0;
+                watch_hit = 0;
+                delta_key = 1;
+                stacked_pc = lastpc;
+                watch_sync();
+                trans_string("\r\n -----------------------------------------------\r\n");
+                TI = 1;
+                IT1 = 0;
+                EX1 = 1;
+                CH = 0;
+                CL = 0;
+                CR = 1;
+                return;
+            case 'X': case 'x':
+                break_dump('X');
+                break;
+            case 'I': case 'i':
+                break_dump('I');
+                break;
+            case 'Q': case 'q':
+                ES = 0;
+                break_armed = 0;
+                sp_addr[-FRAME_PCH_OFFSET] = 0x00;
+                sp_addr[-FRAME_PCL_OFFSET] = 0x00;
+                return;
+            default:
+                break;
+        }
+    }
+}
+
+/**
+ * @brief   Timer 0 interrupt handler that samples the user program's PC.
+ * @details Like int1_handler(), it calls a function so Keil pushes the
+ *          same 13 registers, and the interrupted PC sits at the same
+ *          FRAME_PCH_OFFSET/FRAME_PCL_OFFSET below SP.
+ * @param   None
+ * @return  None
+ */
+void profile_handler() interrupt 1 {
+    TH0 = PROFILE_RELOAD >> 8;
+    TL0 = PROFILE_RELOAD & 0xFF;
+    sp_addr = (unsigned char idata *)SP;
+    profile_sample();
+}
+
+/**
+ * @brief   Counts one PC sample in the histogram.
+ * @details An ESC waiting in SBUF stops the profiler and rewrites the
+ *          stacked return address to 0x0000, so RETI restarts the monitor
+ *          with the histogram left intact in XRAM. Other received bytes
+ *          are left for the user program.
+ * @param   None
+ * @return  None
+ */
+void profile_sample(void)
+{
+    unsigned int pc;
+    unsigned int bucket;
+
+    if (RI && SBUF == PROFILE_STOP_CHAR){
+        RI = 0;
+        profile_stop();
+        sp_addr[-FRAME_PCH_OFFSET] = 0x00;
+        sp_addr[-FRAME_PCL_OFFSET] = 0x00;
+        return;
+    }
+
+    pc = (sp_addr[-FRAME_PCH_OFFSET] << 8) | sp_addr[-FRAME_PCL_OFFSET];
+    profile_total++;
+    bucket = (pc - profile_base) >> profile_shift;
+    if (pc < profile_base || bucket >= PROFILE_BUCKETS){
+        profile_outside++;
+    } else if (profile_hist[bucket] != 0xFFFF){
+        profile_hist[bucket]++;
+    }
+}
+
+/**
+ * @brief   Stops Timer 0 sampling.
+ * @param   None
+ * @return  None
+ */
+void profile_stop(void)
+{
+    TR0 = 0;
+    ET0 = 0;
+    profile_armed = 0;
+}
+
+/**
+ * @brief   Sends one byte of a bulk download and adds it to dump_sum.
+ * @param   value - Byte to transmit.
+ * @return  None
+ */
+void trans_dump(unsigned char value)
+{
+    trans(value);
+    dump_sum += value;
+}
+
+/**
+ * @brief   Sends the profile to the host.
+ * @details Format: PROFILE_DUMP_SYNC, base (2), shift, bucket count (2),
+ *          total samples (4), samples outside the histogram (4), the
+ *          16-bit buckets, and a 16-bit sum of all bytes after the sync.
+ *          Multi-byte values are high byte first. Decoded by
+ *          Host_Tools/prof_view.
+ * @param   None
+ * @return  None
+ */
+void profile_download(void)
+{
+    unsigned int n;
+
+    if (profile_magic != PROFILE_MAGIC){
+        trans_string("\r\n No profile recorded.\r\n");
+        return;
+    }
+    trans_string("\r\n");
+    trans(PROFILE_DUMP_SYNC);
+    dump_sum = 0;
+    trans_dump(profile_base >> 8);
+    trans_dump(profile_base);
+    trans_dump(profile_shift);
+    trans_dump(PROFILE_BUCKETS >> 8);
+    trans_dump(PROFILE_BUCKETS & 0xFF);
+    trans_dump(profile_total >> 24);
+    trans_dump(profile_total >> 16);
+    trans_dump(profile_total >> 8);
+    trans_dump(profile_total);
+    trans_dump(profile_outside >> 24);
+    trans_dump(profile_outside >> 16);
+    trans_dump(profile_outside >> 8);
+    trans_dump(profile_outside);
+    for (n = 0; n < PROFILE_BUCKETS; n++){
+        trans_dump(profile_hist[n] >> 8);
+        trans_dump(profile_hist[n]);
+    }
+    trans(dump_sum >> 8);
+    trans(dump_sum);
+    trans_string("\r\n");
+}
+
+/**
+ * @brief   Arms the profiler or downloads the profile ('P' command).
+ * @details Arming clears the histogram and asks for the bucket size; the
+ *          start address is then asked by jump(), and becomes the base of
+ *          the histogram.
+ * @param   None
+ * @return  None
+ */
+void profile(void)
+{
+    unsigned int n;
+
+    trans_string("\r\n (R)un profiler, (D)ownload profile: ");
+    cmd = typeit();
+    trans(cmd);
+    switch (cmd) {
+        case 'R': case 'r':
+            trans_string("\r\n Bucket size 2^n bytes, n (0-7): ");
+            cmd = typeit();
+            trans(cmd);
+            if (cmd < '0' || cmd > '0' + PROFILE_SHIFT_MAX){
+                trans_string("\r\n Invalid Bucket Size !\r\n");
+                return;
+            }
+            for (n = 0; n < PROFILE_BUCKETS; n++){
+                profile_hist[n] = 0;
+            }
+            profile_shift = cmd - '0';
+            profile_total = 0;
+            profile_outside = 0;
+            profile_magic = PROFILE_MAGIC;
+            profile_armed = 1;
+            jump();
+            break;
+        case 'D': case 'd':
+            profile_download();
+            break;
+        default:
+            trans_string("\r\n Invalid Option !\r\n");
+            break;
+    }
+}
+
+/**
+ * @brief   Executes a memory hexdump starting at address 0x2000.
+ * @details Performs a memory dump by calling the hexdump function 
+ *          located at the specific address.
+ * @param   None
+ * @return  None
+ */
+void hex(void){
+	void (*hexdump)(void) = (void (*)(void))0x2000;
+	hexdump();
+}
+
+
+void main() {
+    uart_init();
+    run_state_init();
+		while(1){
+		help();
+    trans_string("\r\n Enter the Command: ");
+    cmd = typeit();
+    trans(cmd);
+		trans_string("\033[2J\033[H");
+    switch (cmd) {
+				case 'M': case 'm':
+            hex();
+            break;
+        case 'S': case 's':
+            jump_to_user_code();
+            break;
+        case 'B': case 'b':
+            breakpoints();
+            break;
+        case 'R': case 'r':
+            run_to_breakpoint();
+            break;
+        case 'T': case 't':
+            trace();
+            break;
+        case 'P': case 'p':
+            profile();
+            break;
+        case 'C': case 'c':
+            coverage();
+            break;
+        case 'W': case 'w':
+            watchpoints();
+            break;
+        case 'H': case 'h':
+            break;
+				case 'J': case 'j':
+            jump();
+            break;
+        case 'U': case 'u':
+            baud();
             break;
         default:
             trans_string("\r\n Invalid Command !\r\n");